@@ -0,0 +1,47 @@
+#include "bench.hpp"
+#include "memory/FrameArena.hpp"
+#include <vector>
+
+namespace {
+
+	static const int NUM_LISTS = 200;
+	static const int NUM_FRAMES = 200;
+
+	template <typename Vector>
+	void buildLists(Vector& v, int list) {
+		for (int i = 0; i < 50 + list % 100; ++i) {
+			v.push_back(i * list);
+		}
+		bench::doNotOptimize(v.data());
+	}
+
+}
+
+BENCHMARK(frame_arena) {
+	double t = bench::measure([] {
+		for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+			for (int list = 0; list < NUM_LISTS; ++list) {
+				std::vector<int> v;
+				buildLists(v, list);
+			}
+		}
+	});
+	bench::report("heap vectors", t / NUM_FRAMES * 1e6, "us/frame");
+
+	yks::DoubleBufferedArena arenas(4 * 1024);
+	size_t overflows = 0;
+	t = bench::measure([&] {
+		for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+			arenas.nextFrame();
+			yks::ArenaAllocator<int> alloc(arenas.current());
+			for (int list = 0; list < NUM_LISTS; ++list) {
+				std::vector<int, yks::ArenaAllocator<int>> v(alloc);
+				buildLists(v, list);
+			}
+			overflows = arenas.current().getNumOverflows();
+		}
+	});
+	bench::report("arena vectors", t / NUM_FRAMES * 1e6, "us/frame");
+	bench::report("arena high-water mark", arenas.getHighWaterMark() / 1024.0, "KiB");
+	bench::report("overflows in last frame", double(overflows), "allocs");
+}
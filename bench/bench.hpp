@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+namespace bench {
+
+	typedef std::chrono::steady_clock Clock;
+	typedef void (*BenchmarkFn)();
+
+	struct Registrar {
+		Registrar(const char* name, BenchmarkFn fn);
+	};
+
+	/** Defines a benchmark, which is run by the benchmarks executable if its
+	 * name contains the filter passed on the command line. */
+	#define BENCHMARK(name) \
+		static void bench_##name(); \
+		static ::bench::Registrar bench_registrar_##name(#name, &bench_##name); \
+		static void bench_##name()
+
+	/** Records a measured value for the currently running benchmark. */
+	void report(const char* metric, double value, const char* unit);
+
+	/** Reports what as a failure of the currently running benchmark unless
+	 * ok is set. Failed checks make the benchmarks executable exit with 3,
+	 * for benchmarks that also verify a fast path against a reference. */
+	void check(bool ok, const char* what);
+
+	inline double secondsSince(Clock::time_point start) {
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	/** Returns the best time in seconds of running f for a few repetitions. */
+	template <typename F>
+	double measure(F&& f, int repetitions = 5) {
+		double best = 1e30;
+		for (int i = 0; i < repetitions; ++i) {
+			const Clock::time_point start = Clock::now();
+			f();
+			const double t = secondsSince(start);
+			if (t < best) best = t;
+		}
+		return best;
+	}
+
+	/** Keeps the compiler from optimizing away the computation of value. */
+	template <typename T>
+	inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+
+}
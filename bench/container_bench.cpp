@@ -0,0 +1,298 @@
+#include "bench.hpp"
+#include "memory/ObjectPool.hpp"
+#include "memory/TypedDynamicPool.hpp"
+#include "SortedVector.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Compares the libyuriks containers against std ones on the same workload:
+// inserting keyed items, looking them up, iterating over all of them,
+// removing half and then a steady churn of removals and insertions. Each
+// container is looked up through whatever it hands out on insertion, a
+// handle for the pools and the key for everything else.
+
+namespace {
+
+	struct Item {
+		uint32_t key;
+		float data[3];
+
+		// Only needed by SortedVector, which compares whole items on insert
+		bool operator <(const Item& o) const { return key < o.key; }
+	};
+
+	enum class Churn {
+		fifo, // Oldest items are removed first, keys ascend
+		random, // Random items are removed, keys are random
+	};
+
+	static const size_t sizes[] = { 1 << 10, 1 << 14, 1 << 17 };
+
+	// Adapters giving all containers the same interface. Ref is what's kept to
+	// find an item again after inserting it.
+
+	struct ObjectPoolAdapter {
+		static constexpr const char* name = "ObjectPool";
+		static constexpr size_t max_size = SIZE_MAX;
+		typedef yks::Handle Ref;
+
+		yks::ObjectPool<Item> pool;
+
+		Ref insert(const Item& item) { return pool.emplace(item); }
+		const Item* lookup(Ref r) const { return pool[r]; }
+		void remove(Ref r) { pool.remove(r); }
+		template <typename F>
+		void forEach(F&& f) const { for (const Item& item : pool.objects()) f(item); }
+	};
+
+	struct DynamicPoolAdapter {
+		static constexpr const char* name = "TypedDynamicPool";
+		static constexpr size_t max_size = SIZE_MAX;
+		typedef yks::Handle Ref;
+
+		yks::TypedDynamicPool<Item> pool;
+
+		Ref insert(const Item& item) { return pool.insert(item); }
+		const Item* lookup(Ref r) const { return pool[r]; }
+		void remove(Ref r) { pool.remove(r); }
+		template <typename F>
+		void forEach(F&& f) const { for (const Item& item : pool.objects()) f(item); }
+	};
+
+	struct SortedVectorAdapter {
+		static constexpr const char* name = "SortedVector";
+		// Inserting in the middle is O(n), so large sizes take minutes
+		static constexpr size_t max_size = 1 << 14;
+		typedef uint32_t Ref;
+
+		SortedVector<std::pair<uint32_t, Item>> items;
+
+		Ref insert(const Item& item) { items.insert(std::make_pair(item.key, item)); return item.key; }
+		const Item* lookup(Ref r) {
+			auto it = items.lookup(r);
+			return it != items.data.end() ? &it->second : nullptr;
+		}
+		void remove(Ref r) { items.remove(r); }
+		template <typename F>
+		void forEach(F&& f) const { for (const auto& v : items.data) f(v.second); }
+	};
+
+	struct UnorderedMapAdapter {
+		static constexpr const char* name = "std::unordered_map";
+		static constexpr size_t max_size = SIZE_MAX;
+		typedef uint32_t Ref;
+
+		std::unordered_map<uint32_t, Item> items;
+
+		Ref insert(const Item& item) { items.emplace(item.key, item); return item.key; }
+		const Item* lookup(Ref r) const {
+			auto it = items.find(r);
+			return it != items.end() ? &it->second : nullptr;
+		}
+		void remove(Ref r) { items.erase(r); }
+		template <typename F>
+		void forEach(F&& f) const { for (const auto& v : items) f(v.second); }
+	};
+
+	struct MapAdapter {
+		static constexpr const char* name = "std::map";
+		static constexpr size_t max_size = SIZE_MAX;
+		typedef uint32_t Ref;
+
+		std::map<uint32_t, Item> items;
+
+		Ref insert(const Item& item) { items.emplace(item.key, item); return item.key; }
+		const Item* lookup(Ref r) const {
+			auto it = items.find(r);
+			return it != items.end() ? &it->second : nullptr;
+		}
+		void remove(Ref r) { items.erase(r); }
+		template <typename F>
+		void forEach(F&& f) const { for (const auto& v : items) f(v.second); }
+	};
+
+	/** Lower bound for the other containers: items don't keep any identity,
+	 * a Ref is only an index which swap-and-pop removal invalidates, so
+	 * lookups after removals find some other item. */
+	struct VectorAdapter {
+		static constexpr const char* name = "std::vector";
+		static constexpr size_t max_size = SIZE_MAX;
+		typedef size_t Ref;
+
+		std::vector<Item> items;
+
+		Ref insert(const Item& item) { items.push_back(item); return items.size() - 1; }
+		const Item* lookup(Ref r) const { return &items[r % items.size()]; }
+		void remove(Ref r) {
+			items[r % items.size()] = items.back();
+			items.pop_back();
+		}
+		template <typename F>
+		void forEach(F&& f) const { for (const Item& item : items) f(item); }
+	};
+
+	struct PhaseTimes {
+		double insert = 1e30;
+		double lookup = 1e30;
+		double iterate = 1e30;
+		double remove = 1e30;
+		double churn = 1e30;
+	};
+
+	static void keepBest(double& best, double t) {
+		if (t < best) best = t;
+	}
+
+	template <typename Container>
+	void runContainer(size_t n, Churn churn) {
+		typedef typename Container::Ref Ref;
+
+		static const int REPETITIONS = 3;
+		static const int CHURN_ROUNDS = 8;
+
+		// Steady state churn replaces a tenth of the items left after
+		// removing half, per round
+		const size_t per_round = std::max<size_t>((n - n / 2) / 10, 1);
+		const size_t num_keys = n + per_round * CHURN_ROUNDS;
+
+		// Keys must be unique. The first n go to the initial items, the rest
+		// replace churned ones. In order for fifo churn, random otherwise.
+		std::mt19937 rng(1234);
+		std::vector<uint32_t> keys;
+		keys.reserve(num_keys);
+		if (churn == Churn::fifo) {
+			for (size_t i = 0; i < num_keys; ++i) {
+				keys.push_back(uint32_t(i));
+			}
+		} else {
+			while (keys.size() < num_keys) {
+				while (keys.size() < num_keys) {
+					keys.push_back(uint32_t(rng()));
+				}
+				std::sort(keys.begin(), keys.end());
+				keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+			}
+			std::shuffle(keys.begin(), keys.end(), rng);
+		}
+
+		std::vector<Item> items(n);
+		for (size_t i = 0; i < n; ++i) {
+			items[i].key = keys[i];
+			items[i].data[0] = items[i].data[1] = items[i].data[2] = float(i);
+		}
+
+		PhaseTimes best;
+		for (int rep = 0; rep < REPETITIONS; ++rep) {
+			Container c;
+			std::vector<Ref> refs(items.size());
+
+			bench::Clock::time_point start = bench::Clock::now();
+			for (size_t i = 0; i < items.size(); ++i) {
+				refs[i] = c.insert(items[i]);
+			}
+			keepBest(best.insert, bench::secondsSince(start) / items.size());
+
+			std::vector<Ref> lookup_order = refs;
+			std::shuffle(lookup_order.begin(), lookup_order.end(), rng);
+			start = bench::Clock::now();
+			float sum = 0.0f;
+			for (const Ref r : lookup_order) {
+				sum += c.lookup(r)->data[0];
+			}
+			bench::doNotOptimize(sum);
+			keepBest(best.lookup, bench::secondsSince(start) / items.size());
+
+			start = bench::Clock::now();
+			sum = 0.0f;
+			c.forEach([&](const Item& item) { sum += item.data[1]; });
+			bench::doNotOptimize(sum);
+			keepBest(best.iterate, bench::secondsSince(start) / items.size());
+
+			// Remove half, oldest first or at random
+			if (churn == Churn::random) {
+				std::shuffle(refs.begin(), refs.end(), rng);
+			}
+			const size_t num_removed = refs.size() / 2;
+			start = bench::Clock::now();
+			for (size_t i = 0; i < num_removed; ++i) {
+				c.remove(refs[i]);
+			}
+			keepBest(best.remove, bench::secondsSince(start) / num_removed);
+			refs.erase(refs.begin(), refs.begin() + num_removed);
+
+			// Steady state: replace per_round items per round with fresh keys
+			Item item = items[0];
+			size_t next_key = n;
+			size_t oldest = 0; // refs is a ring buffer for fifo churn
+			start = bench::Clock::now();
+			for (int round = 0; round < CHURN_ROUNDS; ++round) {
+				for (size_t i = 0; i < per_round; ++i) {
+					size_t victim;
+					if (churn == Churn::fifo) {
+						victim = oldest;
+						oldest = (oldest + 1) % refs.size();
+					} else {
+						victim = rng() % refs.size();
+					}
+					c.remove(refs[victim]);
+
+					item.key = keys[next_key++];
+					refs[victim] = c.insert(item);
+				}
+			}
+			keepBest(best.churn, bench::secondsSince(start) / (per_round * CHURN_ROUNDS));
+		}
+
+		char metric[128];
+		const char* churn_name = churn == Churn::fifo ? "fifo" : "random";
+		const struct { const char* phase; double t; } phases[] = {
+			{ "insert", best.insert }, { "lookup", best.lookup }, { "iterate", best.iterate },
+			{ "remove", best.remove }, { "churn", best.churn },
+		};
+		for (const auto& p : phases) {
+			std::snprintf(metric, sizeof(metric), "%s n=%zu %s %s", Container::name, n, churn_name, p.phase);
+			bench::report(metric, p.t * 1e9, "ns");
+		}
+	}
+
+	template <typename Container>
+	void runContainerSuite() {
+		for (const size_t n : sizes) {
+			if (n > Container::max_size)
+				continue;
+			runContainer<Container>(n, Churn::fifo);
+			runContainer<Container>(n, Churn::random);
+		}
+	}
+
+}
+
+BENCHMARK(containers_object_pool) {
+	runContainerSuite<ObjectPoolAdapter>();
+}
+
+BENCHMARK(containers_dynamic_pool) {
+	runContainerSuite<DynamicPoolAdapter>();
+}
+
+BENCHMARK(containers_sorted_vector) {
+	runContainerSuite<SortedVectorAdapter>();
+}
+
+BENCHMARK(containers_unordered_map) {
+	runContainerSuite<UnorderedMapAdapter>();
+}
+
+BENCHMARK(containers_map) {
+	runContainerSuite<MapAdapter>();
+}
+
+BENCHMARK(containers_vector) {
+	runContainerSuite<VectorAdapter>();
+}
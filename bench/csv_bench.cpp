@@ -0,0 +1,127 @@
+#include "bench.hpp"
+#include "csv.hpp"
+#include "MappedFile.hpp"
+#include "render/SpriteDb.hpp"
+#include "render/CompiledSpriteDb.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static const char* const SPRITE_CSV_PATH = "bench_sprites.csv";
+static const int NUM_SPRITE_ROWS = 1000000;
+
+static void writeSpriteCsv() {
+	std::ofstream f(SPRITE_CSV_PATH, std::ios::binary);
+	for (int i = 0; i < NUM_SPRITE_ROWS; ++i) {
+		// Mix of plain sprites and 8 frame sequences.
+		f << "sprite_" << (i / 8) << "_frame" << (i % 8 + 1) << ','
+			<< (i % 64) * 32 << ',' << (i / 64 % 64) * 32 << ",32,32\n";
+	}
+}
+
+// The loader SpriteDb used before it switched to CsvReader.
+static size_t loadWithGetline() {
+	std::fstream f(SPRITE_CSV_PATH);
+	size_t sum = 0;
+
+	std::string line;
+	while (std::getline(f, line)) {
+		std::string::size_type pos = 0;
+
+		std::string id = yks::getNextCsvField(line, pos);
+
+		yks::IntRect r;
+		r.x = std::stoi(yks::getNextCsvField(line, pos));
+		r.y = std::stoi(yks::getNextCsvField(line, pos));
+		r.w = std::stoi(yks::getNextCsvField(line, pos));
+		r.h = std::stoi(yks::getNextCsvField(line, pos));
+		sum += id.size() + r.x + r.y + r.w + r.h;
+	}
+
+	return sum;
+}
+
+BENCHMARK(csv_sprite_sheet) {
+	writeSpriteCsv();
+
+	const double rows = NUM_SPRITE_ROWS;
+
+	double t = bench::measure([] { bench::doNotOptimize(loadWithGetline()); }, 3);
+	bench::report("getline+stoi parse", rows / t / 1e6, "Mrows/s");
+
+	t = bench::measure([] {
+		yks::MappedFile f(SPRITE_CSV_PATH);
+		yks::CsvReader csv(f.view());
+		size_t sum = 0;
+		while (csv.nextRow()) {
+			sum += csv.nextField().size();
+			for (int i = 0; i < 4; ++i) {
+				int v;
+				yks::parseCsvInt(csv.nextField(), v);
+				sum += v;
+			}
+		}
+		bench::doNotOptimize(sum);
+	}, 3);
+	bench::report("mmap CsvReader parse", rows / t / 1e6, "Mrows/s");
+
+	t = bench::measure([] {
+		yks::SpriteDb db;
+		db.loadFromCsv(SPRITE_CSV_PATH);
+		bench::doNotOptimize(db.sprites.size());
+	}, 3);
+	bench::report("SpriteDb::loadFromCsv", t * 1e3, "ms");
+
+	std::remove(SPRITE_CSV_PATH);
+}
+
+BENCHMARK(compiled_sprite_db) {
+	static const char* const COMPILED_PATH = "bench_sprites.ysdb";
+
+	for (int rows : { 1000, 100000, NUM_SPRITE_ROWS }) {
+		{
+			std::ofstream f(SPRITE_CSV_PATH, std::ios::binary);
+			for (int i = 0; i < rows; ++i) {
+				f << "sprite_" << (i / 8) << "_frame" << (i % 8 + 1) << ",0,0,32,32\n";
+			}
+		}
+		yks::SpriteDb db;
+		db.loadFromCsv(SPRITE_CSV_PATH);
+		yks::writeCompiledSpriteDb(db, COMPILED_PATH);
+
+		const std::string suffix = " (" + std::to_string(rows) + " rows)";
+
+		double t = bench::measure([] {
+			yks::CompiledSpriteDb compiled;
+			compiled.load(COMPILED_PATH);
+			bench::doNotOptimize(compiled.size());
+		});
+		bench::report(("CompiledSpriteDb::load" + suffix).c_str(), t * 1e6, "us");
+
+		yks::CompiledSpriteDb compiled;
+		compiled.load(COMPILED_PATH);
+		std::vector<std::string> names;
+		for (int i = 0; i < 1000; ++i) {
+			const int row = int(uint32_t(i * 2654435761u) % uint32_t(rows));
+			names.push_back("sprite_" + std::to_string(row / 8) + "_frame" + std::to_string(row % 8 + 1));
+		}
+
+		t = bench::measure([&] {
+			int sum = 0;
+			for (const std::string& name : names) sum += compiled.lookup(name)->w;
+			bench::doNotOptimize(sum);
+		});
+		bench::report(("CompiledSpriteDb::lookup" + suffix).c_str(), t / names.size() * 1e9, "ns");
+
+		t = bench::measure([&] {
+			int sum = 0;
+			for (const std::string& name : names) sum += db.lookup(name).w;
+			bench::doNotOptimize(sum);
+		});
+		bench::report(("SpriteDb::lookup" + suffix).c_str(), t / names.size() * 1e9, "ns");
+	}
+
+	std::remove(SPRITE_CSV_PATH);
+	std::remove(COMPILED_PATH);
+}
@@ -0,0 +1,169 @@
+#include "bench.hpp"
+#include "math/fastmath.hpp"
+#include "srgb.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+	static const size_t NUM_ITEMS = 1 << 16;
+
+	std::vector<float> randomFloats(float lo, float hi, unsigned int seed) {
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> dist(lo, hi);
+		std::vector<float> v(NUM_ITEMS);
+		for (float& f : v) {
+			f = dist(rng);
+		}
+		return v;
+	}
+
+	template <typename F>
+	void reportScalar(const char* metric, const std::vector<float>& in, std::vector<float>& out, F&& f) {
+		const double t = bench::measure([&] {
+			for (size_t i = 0; i < NUM_ITEMS; ++i) {
+				out[i] = f(in[i]);
+			}
+			bench::doNotOptimize(out.data());
+		});
+		bench::report(metric, t * 1e9 / NUM_ITEMS, "ns");
+	}
+
+#ifdef YKS_HAS_SSE2
+	template <typename F>
+	void reportSimd(const char* metric, const std::vector<float>& in, std::vector<float>& out, F&& f) {
+		const double t = bench::measure([&] {
+			for (size_t i = 0; i < NUM_ITEMS; i += 4) {
+				_mm_storeu_ps(&out[i], f(_mm_loadu_ps(&in[i])));
+			}
+			bench::doNotOptimize(out.data());
+		});
+		bench::report(metric, t * 1e9 / NUM_ITEMS, "ns");
+	}
+#endif
+
+	/** Max of error(x) over [lo, hi], lo >= 0, sampling floats by stepping
+	 * through their bit patterns. */
+	template <typename E>
+	double maxError(float lo, float hi, E&& error) {
+		static const uint32_t STEP = 61;
+		uint32_t bits, end_bits;
+		std::memcpy(&bits, &lo, sizeof(bits));
+		std::memcpy(&end_bits, &hi, sizeof(end_bits));
+
+		double max_err = 0.0;
+		for (; bits <= end_bits; bits += STEP) {
+			float x;
+			std::memcpy(&x, &bits, sizeof(x));
+			const double err = error(x);
+			if (err > max_err) max_err = err;
+		}
+		return max_err;
+	}
+
+	/** Reports a max error in units of 1e-7, so that it's readable, and
+	 * fails the run if it's over the bound documented in fastmath.hpp. */
+	void reportError(const char* metric, double max_err, double bound) {
+		bench::report(metric, max_err * 1e7, "1e-7");
+		bench::check(max_err <= bound, metric);
+	}
+
+#ifdef YKS_HAS_SSE2
+	/** Error of fast_pow(x, y) relative to its documented bound. */
+	double powError(float x, float y) {
+		const double ref = std::pow(double(x), double(y));
+		const float result = _mm_cvtss_f32(yks::fast_pow(_mm_set1_ps(x), _mm_set1_ps(y)));
+		return std::abs(double(result) - ref) / ref / (1.0 + std::abs(double(y) * std::log2(double(x))));
+	}
+#endif
+
+}
+
+BENCHMARK(fastmath) {
+	const std::vector<float> angles = randomFloats(-10.0f, 10.0f, 9);
+	const std::vector<float> exponents = randomFloats(-20.0f, 20.0f, 10);
+	const std::vector<float> positives = randomFloats(1e-3f, 1e3f, 11);
+	std::vector<float> out(NUM_ITEMS);
+
+	reportScalar("std::sin", angles, out, [](float x) { return std::sin(x); });
+	reportScalar("fast_sin", angles, out, [](float x) { return yks::fast_sin(x); });
+	reportScalar("std::cos", angles, out, [](float x) { return std::cos(x); });
+	reportScalar("fast_cos", angles, out, [](float x) { return yks::fast_cos(x); });
+	reportScalar("std::exp2", exponents, out, [](float x) { return std::exp2(x); });
+	reportScalar("std::log2", positives, out, [](float x) { return std::log2(x); });
+	reportScalar("std::pow(x, 1/2.4)", positives, out, [](float x) { return std::pow(x, 1.0f / 2.4f); });
+#ifdef YKS_HAS_SSE2
+	reportSimd("fast_sin x4", angles, out, [](__m128 x) { return yks::fast_sin(x); });
+	reportSimd("fast_cos x4", angles, out, [](__m128 x) { return yks::fast_cos(x); });
+	reportSimd("fast_exp2 x4", exponents, out, [](__m128 x) { return yks::fast_exp2(x); });
+	reportSimd("fast_log2 x4", positives, out, [](__m128 x) { return yks::fast_log2(x); });
+	reportSimd("fast_pow(x, 1/2.4) x4", positives, out, [](__m128 x) { return yks::fast_pow(x, _mm_set1_ps(1.0f / 2.4f)); });
+#endif
+
+	reportError("fast_sin max abs error", maxError(0.0f, 8192.0f, [](float x) {
+		return std::abs(double(yks::fast_sin(x)) - std::sin(double(x)));
+	}), 1e-7);
+	reportError("fast_cos max abs error", maxError(0.0f, 8192.0f, [](float x) {
+		return std::abs(double(yks::fast_cos(x)) - std::cos(double(x)));
+	}), 1e-7);
+#ifdef YKS_HAS_SSE2
+	reportError("fast_sin x4 max abs error", maxError(0.0f, 8192.0f, [](float x) {
+		return std::abs(double(_mm_cvtss_f32(yks::fast_sin(_mm_set1_ps(x)))) - std::sin(double(x)));
+	}), 1e-7);
+	reportError("fast_cos x4 max abs error", maxError(0.0f, 8192.0f, [](float x) {
+		return std::abs(double(_mm_cvtss_f32(yks::fast_cos(_mm_set1_ps(x)))) - std::cos(double(x)));
+	}), 1e-7);
+	reportError("fast_exp2 max rel error", maxError(0.0f, 127.0f, [](float x) {
+		const double ref = std::exp2(double(x));
+		return std::abs(double(_mm_cvtss_f32(yks::fast_exp2(_mm_set1_ps(x)))) - ref) / ref;
+	}), 1.1e-7);
+	reportError("fast_exp2 max rel error, x < 0", maxError(0.0f, 126.0f, [](float x) {
+		const double ref = std::exp2(-double(x));
+		return std::abs(double(_mm_cvtss_f32(yks::fast_exp2(_mm_set1_ps(-x)))) - ref) / ref;
+	}), 1.1e-7);
+	// Scaled by max(1, |log2(x)|), since away from 1 the error is dominated
+	// by rounding the exponent part
+	reportError("fast_log2 max scaled abs error", maxError(FLT_MIN, FLT_MAX, [](float x) {
+		const double ref = std::log2(double(x));
+		const double err = std::abs(double(_mm_cvtss_f32(yks::fast_log2(_mm_set1_ps(x)))) - ref);
+		return err / std::max(1.0, std::abs(ref));
+	}), 1.2e-7);
+	// Scaled by 1 + |y*log2(x)|. x is kept to where y*log2(x) stays inside
+	// the range of fast_exp2.
+	reportError("fast_pow(x, 1/2.4) max scaled rel error", maxError(FLT_MIN, FLT_MAX, [](float x) {
+		return powError(x, 1.0f / 2.4f);
+	}), 1e-7);
+	reportError("fast_pow(x, 2.4) max scaled rel error", maxError(0x1p-52f, 0x1p52f, [](float x) {
+		return powError(x, 2.4f);
+	}), 1e-7);
+	reportError("fast_pow(x, -2.4) max scaled rel error", maxError(0x1p-52f, 0x1p52f, [](float x) {
+		return powError(x, -2.4f);
+	}), 1e-7);
+#endif
+}
+
+BENCHMARK(srgb) {
+	const std::vector<float> linear = randomFloats(0.0f, 1.0f, 12);
+	std::vector<uint8_t> out(NUM_ITEMS);
+
+	double t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_ITEMS; ++i) {
+			out[i] = uint8_t(yks::srgb_from_linear(linear[i]) * 255.0f + 0.5f);
+		}
+		bench::doNotOptimize(out.data());
+	});
+	bench::report("pow", t * 1e9 / NUM_ITEMS, "ns");
+
+	t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_ITEMS; ++i) {
+			out[i] = yks::byte_from_linear(linear[i]);
+		}
+		bench::doNotOptimize(out.data());
+	});
+	bench::report("byte_from_linear", t * 1e9 / NUM_ITEMS, "ns");
+}
@@ -0,0 +1,125 @@
+#include "bench.hpp"
+#include "FlatHashMap.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+	static const size_t sizes[] = { 1000, 10000, 100000, 1000000 };
+
+	std::string spriteName(uint32_t i) {
+		char name[48];
+		std::snprintf(name, sizeof(name), "sprite_%u_frame%u", i / 8, i % 8 + 1);
+		return name;
+	}
+
+	/** Runs the same workload on Map with keys made by make_key. */
+	template <typename Map, typename Key, typename MakeKey>
+	void runMap(const char* map_name, const char* key_name, size_t n, MakeKey make_key) {
+		std::vector<Key> keys;
+		std::vector<Key> missing_keys;
+		keys.reserve(n);
+		missing_keys.reserve(n);
+		for (size_t i = 0; i < n; ++i) {
+			keys.push_back(make_key(uint32_t(i)));
+			missing_keys.push_back(make_key(uint32_t(n + i)));
+		}
+		std::vector<Key> lookup_keys = keys;
+		std::shuffle(lookup_keys.begin(), lookup_keys.end(), std::mt19937(1));
+
+		double t_insert = 1e30, t_insert_reserved = 1e30, t_hit = 1e30, t_miss = 1e30, t_iterate = 1e30, t_erase = 1e30;
+		for (int rep = 0; rep < 3; ++rep) {
+			{
+				Map m;
+				const bench::Clock::time_point start = bench::Clock::now();
+				for (size_t i = 0; i < n; ++i) {
+					m.emplace(keys[i], uint32_t(i));
+				}
+				t_insert = std::min(t_insert, bench::secondsSince(start));
+			}
+
+			Map m;
+			bench::Clock::time_point start = bench::Clock::now();
+			m.reserve(n);
+			for (size_t i = 0; i < n; ++i) {
+				m.emplace(keys[i], uint32_t(i));
+			}
+			t_insert_reserved = std::min(t_insert_reserved, bench::secondsSince(start));
+
+			start = bench::Clock::now();
+			uint32_t sum = 0;
+			for (const Key& k : lookup_keys) {
+				sum += m.find(k)->second;
+			}
+			bench::doNotOptimize(sum);
+			t_hit = std::min(t_hit, bench::secondsSince(start));
+
+			start = bench::Clock::now();
+			size_t found = 0;
+			for (const Key& k : missing_keys) {
+				found += m.find(k) != m.end();
+			}
+			bench::doNotOptimize(found);
+			t_miss = std::min(t_miss, bench::secondsSince(start));
+
+			start = bench::Clock::now();
+			sum = 0;
+			for (const auto& entry : m) {
+				sum += entry.second;
+			}
+			bench::doNotOptimize(sum);
+			t_iterate = std::min(t_iterate, bench::secondsSince(start));
+
+			start = bench::Clock::now();
+			for (const Key& k : lookup_keys) {
+				m.erase(k);
+			}
+			t_erase = std::min(t_erase, bench::secondsSince(start));
+		}
+
+		char metric[96];
+		const struct { const char* op; double t; } ops[] = {
+			{ "insert", t_insert }, { "insert reserved", t_insert_reserved }, { "find hit", t_hit },
+			{ "find miss", t_miss }, { "iterate", t_iterate }, { "erase", t_erase },
+		};
+		for (const auto& op : ops) {
+			std::snprintf(metric, sizeof(metric), "%s %s n=%zu %s", map_name, key_name, n, op.op);
+			bench::report(metric, op.t * 1e9 / n, "ns");
+		}
+	}
+
+	uint32_t intKey(uint32_t i) {
+		return i * 2654435761u;
+	}
+
+}
+
+BENCHMARK(hash_map_int) {
+	for (const size_t n : sizes) {
+		runMap<yks::FlatHashMap<uint32_t, uint32_t>, uint32_t>("FlatHashMap", "u32", n, intKey);
+		runMap<std::unordered_map<uint32_t, uint32_t>, uint32_t>("unordered_map", "u32", n, intKey);
+	}
+}
+
+BENCHMARK(hash_map_string) {
+	// FlatHashMap is searched with string_views, like SpriteDb does with CSV
+	// fields.
+	for (const size_t n : sizes) {
+		std::vector<std::string> names;
+		names.reserve(2 * n);
+		for (uint32_t i = 0; i < 2 * n; ++i) {
+			names.push_back(spriteName(i));
+		}
+		auto make_view = [&](uint32_t i) { return std::string_view(names[i]); };
+		auto make_string = [&](uint32_t i) { return names[i]; };
+
+		runMap<yks::FlatHashMap<std::string, uint32_t>, std::string_view>("FlatHashMap", "string", n, make_view);
+		// No heterogeneous lookup before C++20, so it has to be given strings
+		runMap<std::unordered_map<std::string, uint32_t>, std::string>("unordered_map", "string", n, make_string);
+	}
+}
@@ -0,0 +1,260 @@
+#include "bench.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+	struct Benchmark {
+		const char* name;
+		BenchmarkFn fn;
+	};
+
+	struct Result {
+		std::string benchmark;
+		std::string metric;
+		double value;
+		std::string unit;
+	};
+
+	static std::vector<Benchmark>& getBenchmarks() {
+		static std::vector<Benchmark> benchmarks;
+		return benchmarks;
+	}
+
+	static const char* current_benchmark = "";
+	static std::vector<Result> results;
+	static int num_failed_checks = 0;
+
+	Registrar::Registrar(const char* name, BenchmarkFn fn) {
+		getBenchmarks().push_back(Benchmark{ name, fn });
+	}
+
+	void report(const char* metric, double value, const char* unit) {
+		std::printf("%-32s %-40s %14.3f %s\n", current_benchmark, metric, value, unit);
+		std::fflush(stdout);
+		results.push_back(Result{ current_benchmark, metric, value, unit });
+	}
+
+	void check(bool ok, const char* what) {
+		if (ok)
+			return;
+
+		std::printf("%-32s CHECK FAILED: %s\n", current_benchmark, what);
+		std::fflush(stdout);
+		++num_failed_checks;
+	}
+
+	/** Rates are better when higher, everything else (times, sizes) when lower. */
+	static bool higherIsBetter(const std::string& unit) {
+		return unit.size() >= 2 && unit.compare(unit.size() - 2, 2, "/s") == 0;
+	}
+
+	static void writeCsvField(std::ostream& out, const std::string& s) {
+		out << '"';
+		for (char c : s) {
+			if (c == '"') out << '"';
+			out << c;
+		}
+		out << '"';
+	}
+
+	static bool writeCsv(const char* path) {
+		std::ofstream out(path);
+		if (!out)
+			return false;
+
+		char value[64];
+		out << "benchmark,metric,value,unit\n";
+		for (const Result& r : results) {
+			std::snprintf(value, sizeof(value), "%.6g", r.value);
+			writeCsvField(out, r.benchmark);
+			out << ',';
+			writeCsvField(out, r.metric);
+			out << ',' << value << ',';
+			writeCsvField(out, r.unit);
+			out << '\n';
+		}
+		return bool(out);
+	}
+
+	static void writeJsonString(std::ostream& out, const std::string& s) {
+		out << '"';
+		for (char c : s) {
+			if (c == '"' || c == '\\') out << '\\';
+			out << c;
+		}
+		out << '"';
+	}
+
+	static bool writeJson(const char* path) {
+		std::ofstream out(path);
+		if (!out)
+			return false;
+
+		char value[64];
+		out << "[\n";
+		for (size_t i = 0; i < results.size(); ++i) {
+			const Result& r = results[i];
+			std::snprintf(value, sizeof(value), "%.6g", r.value);
+			out << "\t{ \"benchmark\": ";
+			writeJsonString(out, r.benchmark);
+			out << ", \"metric\": ";
+			writeJsonString(out, r.metric);
+			out << ", \"value\": " << value << ", \"unit\": ";
+			writeJsonString(out, r.unit);
+			out << (i + 1 < results.size() ? " },\n" : " }\n");
+		}
+		out << "]\n";
+		return bool(out);
+	}
+
+	/** Splits a line written by writeCsv into its fields. */
+	static std::vector<std::string> parseCsvLine(const std::string& line) {
+		std::vector<std::string> fields(1);
+		bool quoted = false;
+		for (size_t i = 0; i < line.size(); ++i) {
+			const char c = line[i];
+			if (quoted) {
+				if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+					fields.back() += '"';
+					++i;
+				} else if (c == '"') {
+					quoted = false;
+				} else {
+					fields.back() += c;
+				}
+			} else if (c == '"') {
+				quoted = true;
+			} else if (c == ',') {
+				fields.emplace_back();
+			} else if (c != '\r') {
+				fields.back() += c;
+			}
+		}
+		return fields;
+	}
+
+	static bool readCsv(const char* path, std::vector<Result>& out_results) {
+		std::ifstream in(path);
+		if (!in)
+			return false;
+
+		std::string line;
+		std::getline(in, line); // Header
+		while (std::getline(in, line)) {
+			const std::vector<std::string> fields = parseCsvLine(line);
+			if (fields.size() != 4)
+				continue;
+			out_results.push_back(Result{ fields[0], fields[1], std::atof(fields[2].c_str()), fields[3] });
+		}
+		return true;
+	}
+
+	/** Prints the change of every result also in the baseline, returning the
+	 * number that got worse by more than threshold percent. */
+	static int compareWithBaseline(const std::vector<Result>& baseline, double threshold) {
+		int num_regressions = 0;
+
+		std::printf("\n%-32s %-40s %14s %14s %8s\n", "benchmark", "metric", "baseline", "current", "change");
+		for (const Result& r : results) {
+			const Result* base = nullptr;
+			for (const Result& b : baseline) {
+				if (b.benchmark == r.benchmark && b.metric == r.metric && b.unit == r.unit) {
+					base = &b;
+					break;
+				}
+			}
+			if (base == nullptr || base->value == 0.0)
+				continue;
+
+			const double change = (r.value - base->value) / base->value * 100.0;
+			const double worse_by = higherIsBetter(r.unit) ? -change : change;
+			const bool regressed = worse_by > threshold;
+			if (regressed) ++num_regressions;
+
+			std::printf("%-32s %-40s %14.3f %14.3f %+7.1f%%%s\n", r.benchmark.c_str(), r.metric.c_str(),
+				base->value, r.value, change, regressed ? "  REGRESSION" : "");
+		}
+
+		std::printf("\n%d regression(s) over %.1f%%\n", num_regressions, threshold);
+		return num_regressions;
+	}
+
+}
+
+static void printUsage(const char* exe) {
+	std::fprintf(stderr,
+		"usage: %s [filter] [--csv FILE] [--json FILE] [--baseline FILE] [--threshold PERCENT]\n"
+		"  filter       only run benchmarks whose name contains it\n"
+		"  --csv        write results as CSV, usable as a later baseline\n"
+		"  --json       write results as JSON\n"
+		"  --baseline   compare against a CSV from an earlier run; exits with 1 on regressions\n"
+		"  --threshold  allowed slowdown before a result counts as a regression (default 10)\n"
+		"exits with 3 if a benchmark's correctness check failed\n",
+		exe);
+}
+
+int main(int argc, char* argv[]) {
+	const char* filter = "";
+	const char* csv_path = nullptr;
+	const char* json_path = nullptr;
+	const char* baseline_path = nullptr;
+	double threshold = 10.0;
+
+	for (int i = 1; i < argc; ++i) {
+		const bool has_value = i + 1 < argc;
+		if (std::strcmp(argv[i], "--csv") == 0 && has_value) {
+			csv_path = argv[++i];
+		} else if (std::strcmp(argv[i], "--json") == 0 && has_value) {
+			json_path = argv[++i];
+		} else if (std::strcmp(argv[i], "--baseline") == 0 && has_value) {
+			baseline_path = argv[++i];
+		} else if (std::strcmp(argv[i], "--threshold") == 0 && has_value) {
+			threshold = std::atof(argv[++i]);
+		} else if (argv[i][0] == '-') {
+			printUsage(argv[0]);
+			return 2;
+		} else {
+			filter = argv[i];
+		}
+	}
+
+	// Read the baseline first so a bad path doesn't waste a whole run
+	std::vector<bench::Result> baseline;
+	if (baseline_path != nullptr && !bench::readCsv(baseline_path, baseline)) {
+		std::fprintf(stderr, "Couldn't read baseline %s\n", baseline_path);
+		return 2;
+	}
+
+	for (const bench::Benchmark& b : bench::getBenchmarks()) {
+		if (std::strstr(b.name, filter) == nullptr)
+			continue;
+
+		bench::current_benchmark = b.name;
+		b.fn();
+	}
+
+	if (csv_path != nullptr && !bench::writeCsv(csv_path)) {
+		std::fprintf(stderr, "Couldn't write %s\n", csv_path);
+		return 2;
+	}
+	if (json_path != nullptr && !bench::writeJson(json_path)) {
+		std::fprintf(stderr, "Couldn't write %s\n", json_path);
+		return 2;
+	}
+
+	int status = 0;
+	if (baseline_path != nullptr && bench::compareWithBaseline(baseline, threshold) > 0) {
+		status = 1;
+	}
+	if (bench::num_failed_checks > 0) {
+		std::fprintf(stderr, "%d check(s) failed\n", bench::num_failed_checks);
+		status = 3;
+	}
+
+	return status;
+}
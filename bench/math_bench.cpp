@@ -0,0 +1,213 @@
+#include "bench.hpp"
+#include "math/mat.hpp"
+#include "math/MatrixTransform.hpp"
+#include "simd.hpp"
+#include <random>
+#include <vector>
+
+namespace {
+
+	static const size_t NUM_ITEMS = 1 << 16;
+
+	yks::mat4 randomMat4(std::mt19937& rng) {
+		std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+		yks::mat4 m;
+		for (unsigned int i = 0; i < 4; ++i) {
+			for (unsigned int j = 0; j < 4; ++j) {
+				m(i, j) = dist(rng);
+			}
+		}
+		return m;
+	}
+
+	/** Checks that the first count floats of a and b are equal. Zeros of
+	 * either sign count as equal, which is as close as the SSE2 versions
+	 * promise to match the reference. */
+	bool sameValues(const float* a, const float* b, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			if (!(a[i] == b[i]))
+				return false;
+		}
+		return true;
+	}
+
+	// Products added left to right, like the SSE2 versions promise. The
+	// generic templates can't be used for this, since -ffast-math is free
+	// to reorder their sums.
+	yks::mat4 referenceMul(const yks::mat4& a, const yks::mat4& b) {
+		yks::mat4 vr;
+		for (unsigned int m = 0; m < 4; ++m) {
+			for (unsigned int p = 0; p < 4; ++p) {
+				float s = 0.0f;
+				for (unsigned int n = 0; n < 4; ++n) {
+					s = yks::noReassociate(s + a(m, n) * b(n, p));
+				}
+				vr(m, p) = s;
+			}
+		}
+		return vr;
+	}
+
+	yks::vec4 referenceMul(const yks::mat4& m, const yks::vec4& v) {
+		yks::vec4 vr;
+		for (unsigned int r = 0; r < 4; ++r) {
+			float s = 0.0f;
+			for (unsigned int c = 0; c < 4; ++c) {
+				s = yks::noReassociate(s + m(r, c) * v[c]);
+			}
+			vr[r] = s;
+		}
+		return vr;
+	}
+
+	yks::vec4 referenceMul(const yks::vec4& v, const yks::mat4& m) {
+		yks::vec4 vr;
+		for (unsigned int c = 0; c < 4; ++c) {
+			float s = 0.0f;
+			for (unsigned int r = 0; r < 4; ++r) {
+				s = yks::noReassociate(s + m(r, c) * v[r]);
+			}
+			vr[c] = s;
+		}
+		return vr;
+	}
+
+	const float* floats(const yks::vec4& v) { return &v[0]; }
+	const float* floats(const yks::mat4& m) { return &m.data[0][0]; }
+
+	template <typename T>
+	bool sameValues(const std::vector<T>& a, const std::vector<T>& b, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			if (!sameValues(floats(a[i]), floats(b[i]), sizeof(T) / sizeof(float)))
+				return false;
+		}
+		return true;
+	}
+
+}
+
+// The generic versions are called by naming the template explicitly
+BENCHMARK(mat4_ops) {
+	std::mt19937 rng(5);
+	std::vector<yks::mat4> mats(NUM_ITEMS);
+	std::vector<yks::vec4> vecs(NUM_ITEMS);
+	for (size_t i = 0; i < NUM_ITEMS; ++i) {
+		mats[i] = randomMat4(rng);
+		vecs[i] = yks::mvec4(float(i), 1.0f, 2.0f, 1.0f);
+	}
+	std::vector<yks::mat4> out_mats(NUM_ITEMS), generic_mats(NUM_ITEMS);
+	std::vector<yks::vec4> out_vecs(NUM_ITEMS), generic_vecs(NUM_ITEMS);
+	std::vector<yks::mat4> reference_mats(NUM_ITEMS);
+	std::vector<yks::vec4> reference_vecs(NUM_ITEMS);
+
+	double t = bench::measure([&] {
+		for (size_t i = 0; i + 1 < NUM_ITEMS; ++i) {
+			generic_mats[i] = yks::operator*<4, 4, 4, float>(mats[i], mats[i + 1]);
+		}
+		bench::doNotOptimize(generic_mats.data());
+	});
+	bench::report("mat4 * mat4, generic", t * 1e9 / NUM_ITEMS, "ns");
+
+	t = bench::measure([&] {
+		for (size_t i = 0; i + 1 < NUM_ITEMS; ++i) {
+			out_mats[i] = mats[i] * mats[i + 1];
+		}
+		bench::doNotOptimize(out_mats.data());
+	});
+	bench::report("mat4 * mat4", t * 1e9 / NUM_ITEMS, "ns");
+	for (size_t i = 0; i + 1 < NUM_ITEMS; ++i) {
+		reference_mats[i] = referenceMul(mats[i], mats[i + 1]);
+	}
+	bench::check(sameValues(out_mats, reference_mats, NUM_ITEMS - 1), "mat4 * mat4 differs from reference");
+
+	t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_ITEMS; ++i) {
+			generic_vecs[i] = yks::operator*<4, 4, float>(mats[i], vecs[i]);
+		}
+		bench::doNotOptimize(generic_vecs.data());
+	});
+	bench::report("mat4 * vec4, generic", t * 1e9 / NUM_ITEMS, "ns");
+
+	t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_ITEMS; ++i) {
+			out_vecs[i] = mats[i] * vecs[i];
+		}
+		bench::doNotOptimize(out_vecs.data());
+	});
+	bench::report("mat4 * vec4", t * 1e9 / NUM_ITEMS, "ns");
+	for (size_t i = 0; i < NUM_ITEMS; ++i) {
+		reference_vecs[i] = referenceMul(mats[i], vecs[i]);
+	}
+	bench::check(sameValues(out_vecs, reference_vecs, NUM_ITEMS), "mat4 * vec4 differs from reference");
+
+	for (size_t i = 0; i < NUM_ITEMS; ++i) {
+		reference_vecs[i] = referenceMul(vecs[i], mats[i]);
+		out_vecs[i] = vecs[i] * mats[i];
+	}
+	bench::check(sameValues(out_vecs, reference_vecs, NUM_ITEMS), "vec4 * mat4 differs from reference");
+
+	t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_ITEMS; ++i) {
+			generic_mats[i] = yks::transpose<4, 4, float>(mats[i]);
+		}
+		bench::doNotOptimize(generic_mats.data());
+	});
+	bench::report("transpose, generic", t * 1e9 / NUM_ITEMS, "ns");
+
+	t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_ITEMS; ++i) {
+			out_mats[i] = yks::transpose(mats[i]);
+		}
+		bench::doNotOptimize(out_mats.data());
+	});
+	bench::report("transpose", t * 1e9 / NUM_ITEMS, "ns");
+	bench::check(sameValues(out_mats, generic_mats, NUM_ITEMS), "transpose differs from generic");
+}
+
+BENCHMARK(transform_points) {
+	static const size_t NUM_POINTS = 1 << 20;
+
+	std::mt19937 rng(6);
+	const yks::mat4 m = randomMat4(rng);
+
+	std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+	std::vector<yks::vec3> points(NUM_POINTS);
+	std::vector<float> xs(NUM_POINTS), ys(NUM_POINTS), zs(NUM_POINTS);
+	for (size_t i = 0; i < NUM_POINTS; ++i) {
+		points[i] = yks::mvec3(dist(rng), dist(rng), dist(rng));
+		xs[i] = points[i][0];
+		ys[i] = points[i][1];
+		zs[i] = points[i][2];
+	}
+
+	std::vector<yks::vec3> out_points(NUM_POINTS);
+	double t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_POINTS; ++i) {
+			out_points[i] = yks::mvec3(m * yks::mvec4(points[i], 1.0f));
+		}
+		bench::doNotOptimize(out_points.data());
+	});
+	bench::report("AoS mat4 * vec4", t * 1e9 / NUM_POINTS, "ns");
+
+	std::vector<float> out_x(NUM_POINTS), out_y(NUM_POINTS), out_z(NUM_POINTS);
+	t = bench::measure([&] {
+		yks::transform_points(m, xs.data(), ys.data(), zs.data(), out_x.data(), out_y.data(), out_z.data(), NUM_POINTS);
+		bench::doNotOptimize(out_x.data());
+	});
+	bench::report("SoA transform_points", t * 1e9 / NUM_POINTS, "ns");
+
+	// The batch transforms must match mat4 * vec4 with the products added
+	// left to right
+	const auto matchesReference = [&](float w) {
+		for (size_t i = 0; i < NUM_POINTS; ++i) {
+			const yks::vec4 expected = referenceMul(m, yks::mvec4(points[i], w));
+			const float got[] = { out_x[i], out_y[i], out_z[i] };
+			if (!sameValues(got, &expected[0], 3))
+				return false;
+		}
+		return true;
+	};
+	bench::check(matchesReference(1.0f), "transform_points differs from reference");
+	yks::transform_directions(m, xs.data(), ys.data(), zs.data(), out_x.data(), out_y.data(), out_z.data(), NUM_POINTS);
+	bench::check(matchesReference(0.0f), "transform_directions differs from reference");
+}
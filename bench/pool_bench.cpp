@@ -0,0 +1,230 @@
+#include "bench.hpp"
+#include "memory/ConcurrentObjectPool.hpp"
+#include "memory/ObjectPool.hpp"
+#include "memory/SnapshotDelta.hpp"
+#include "memory/TypedDynamicPool.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	struct Particle {
+		float pos[4];
+		float vel[4];
+		float color[4];
+		float life, size, rotation, spin;
+	};
+
+	void insertLatency(const char* name, yks::PoolGrowth growth) {
+		static const size_t NUM_INSERTS = 1 << 21;
+
+		std::vector<double> latencies(NUM_INSERTS);
+		Particle p = {};
+
+		yks::TypedDynamicPool<Particle> pool(growth);
+		const bench::Clock::time_point start = bench::Clock::now();
+		for (size_t i = 0; i < NUM_INSERTS; ++i) {
+			const bench::Clock::time_point t0 = bench::Clock::now();
+			pool.insert(p);
+			latencies[i] = bench::secondsSince(t0);
+		}
+		const double total = bench::secondsSince(start);
+		bench::doNotOptimize(pool[pool.makeHandle(0)]);
+
+		std::sort(latencies.begin(), latencies.end());
+		char metric[64];
+		std::snprintf(metric, sizeof(metric), "%s total", name);
+		bench::report(metric, total * 1e3, "ms");
+		std::snprintf(metric, sizeof(metric), "%s p99.9", name);
+		bench::report(metric, latencies[NUM_INSERTS - NUM_INSERTS / 1000] * 1e9, "ns");
+		std::snprintf(metric, sizeof(metric), "%s max", name);
+		bench::report(metric, latencies.back() * 1e6, "us");
+	}
+
+}
+
+BENCHMARK(dynamic_pool_insert_latency) {
+	insertLatency("contiguous", yks::PoolGrowth::contiguous);
+	insertLatency("chunked", yks::PoolGrowth::chunked);
+}
+
+BENCHMARK(object_pool_spawn_despawn) {
+	static const size_t NUM_RESIDENT = 50000;
+	static const size_t NUM_PER_FRAME = 10000;
+	static const int NUM_FRAMES = 50;
+
+	const std::vector<Particle> spawned(NUM_PER_FRAME, Particle());
+	std::vector<yks::Handle> handles(NUM_RESIDENT + NUM_PER_FRAME);
+
+	yks::ObjectPool<Particle> pool;
+	for (size_t i = 0; i < NUM_RESIDENT; ++i) {
+		handles[i] = pool.emplace();
+	}
+
+	// Each frame spawns a batch and despawns the oldest batch
+	size_t oldest = 0;
+	double t = bench::measure([&] {
+		for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+			for (size_t i = 0; i < NUM_PER_FRAME; ++i) {
+				handles[(oldest + NUM_RESIDENT + i) % handles.size()] = pool.emplace(spawned[i]);
+			}
+			for (size_t i = 0; i < NUM_PER_FRAME; ++i) {
+				pool.remove(handles[(oldest + i) % handles.size()]);
+			}
+			oldest = (oldest + NUM_PER_FRAME) % handles.size();
+		}
+	});
+	bench::report("one at a time", t / NUM_FRAMES * 1e6, "us/frame");
+
+	t = bench::measure([&] {
+		for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+			pool.insertBulk(spawned, &handles[(oldest + NUM_RESIDENT) % handles.size()]);
+			for (size_t i = 0; i < NUM_PER_FRAME; ++i) {
+				pool.remove(handles[oldest + i]);
+			}
+			oldest = (oldest + NUM_PER_FRAME) % handles.size();
+		}
+	});
+	bench::report("bulk insert", t / NUM_FRAMES * 1e6, "us/frame");
+
+	float sum = 0.0f;
+	for (const Particle& p : pool.objects()) {
+		sum += p.life;
+	}
+	bench::doNotOptimize(sum);
+}
+
+BENCHMARK(concurrent_pool_scaling) {
+	static const int OPS_PER_THREAD = 1 << 18;
+	static const int BATCH = 32;
+
+	for (int num_threads = 1; num_threads <= 16; num_threads *= 2) {
+		yks::ConcurrentObjectPool<Particle, yks::Handle32> pool;
+
+		// Each thread spawns a batch of objects, then despawns them
+		auto worker = [&pool] {
+			yks::Handle32 handles[BATCH];
+			for (int i = 0; i < OPS_PER_THREAD; i += BATCH) {
+				for (int j = 0; j < BATCH; ++j) {
+					handles[j] = pool.emplace();
+				}
+				for (int j = 0; j < BATCH; ++j) {
+					pool.remove(handles[j]);
+				}
+			}
+		};
+
+		const bench::Clock::time_point start = bench::Clock::now();
+		std::vector<std::thread> threads;
+		for (int i = 0; i < num_threads; ++i) {
+			threads.emplace_back(worker);
+		}
+		for (std::thread& t : threads) {
+			t.join();
+		}
+		const double t = bench::secondsSince(start);
+
+		char metric[64];
+		std::snprintf(metric, sizeof(metric), "%d threads", num_threads);
+		bench::report(metric, double(OPS_PER_THREAD) * num_threads / t * 1e-6, "Mops/s");
+	}
+}
+
+BENCHMARK(object_pool_sort_locality) {
+	static const size_t NUM_OBJECTS = 200000;
+	static const size_t NUM_CELLS = 1 << 16;
+	static const size_t CHURN_PER_FRAME = 500;
+
+	struct Sprite {
+		uint32_t cell;
+		float data[15];
+	};
+
+	// Per-cell data looked up while iterating, like a spatial grid
+	std::vector<float> cells(NUM_CELLS * 16, 1.0f);
+	auto update = [&](yks::ObjectPool<Sprite>& pool) {
+		float sum = 0.0f;
+		for (const Sprite& s : pool.objects()) {
+			sum += cells[s.cell * 16] * s.data[0];
+		}
+		bench::doNotOptimize(sum);
+	};
+	auto cellKey = [](const Sprite& s) { return s.cell; };
+
+	std::mt19937 rng(1);
+	yks::ObjectPool<Sprite> pool;
+	std::vector<yks::Handle> handles;
+	for (size_t i = 0; i < NUM_OBJECTS; ++i) {
+		handles.push_back(pool.emplace(Sprite{ uint32_t(rng() % NUM_CELLS), { 1.0f } }));
+	}
+
+	double t = bench::measure([&] { update(pool); });
+	bench::report("iterate unsorted", t * 1e6, "us");
+
+	t = bench::measure([&] { pool.sortBy(cellKey); }, 1);
+	bench::report("sortBy", t * 1e3, "ms");
+
+	t = bench::measure([&] { update(pool); });
+	bench::report("iterate sorted", t * 1e6, "us");
+
+	// Churn, keeping it sorted with a small budget every frame
+	const bench::Clock::time_point start = bench::Clock::now();
+	for (int frame = 0; frame < 100; ++frame) {
+		for (size_t i = 0; i < CHURN_PER_FRAME; ++i) {
+			const size_t j = rng() % handles.size();
+			pool.remove(handles[j]);
+			handles[j] = pool.emplace(Sprite{ uint32_t(rng() % NUM_CELLS), { 1.0f } });
+		}
+		pool.sortIncremental(cellKey, std::chrono::microseconds(500));
+	}
+	bench::report("churn + sortIncremental", bench::secondsSince(start) / 100 * 1e3, "ms/frame");
+
+	t = bench::measure([&] { update(pool); });
+	bench::report("iterate after churn", t * 1e6, "us");
+}
+
+BENCHMARK(dynamic_pool_snapshot) {
+	static const size_t NUM_OBJECTS = 1 << 20;
+
+	yks::TypedDynamicPool<Particle> pool;
+	std::vector<yks::Handle> handles(NUM_OBJECTS);
+	std::vector<Particle> particles(NUM_OBJECTS, Particle());
+	pool.insertBulk(particles, handles.data());
+
+	std::vector<uint8_t> base(pool.getSnapshotSize());
+	double t = bench::measure([&] { pool.snapshot(base.data(), base.size()); });
+	bench::report("snapshot", t * 1e3, "ms");
+	bench::report("snapshot size", base.size() / (1024.0 * 1024.0), "MiB");
+
+	t = bench::measure([&] { pool.restore(base.data(), base.size()); });
+	bench::report("restore", t * 1e3, "ms");
+
+	// Change 1% of the objects, like a frame of gameplay would
+	for (size_t i = 0; i < NUM_OBJECTS; i += 100) {
+		pool[handles[i * 7919 % NUM_OBJECTS]]->life += 1.0f;
+	}
+	std::vector<uint8_t> target(pool.getSnapshotSize());
+	pool.snapshot(target.data(), target.size());
+
+	std::vector<uint8_t> delta(yks::getMaxSnapshotDeltaSize(target.size()));
+	size_t delta_size = 0;
+	t = bench::measure([&] {
+		delta_size = yks::diffSnapshots(base.data(), base.size(), target.data(), target.size(), delta.data(), delta.size());
+	});
+	bench::report("diff", t * 1e3, "ms");
+	bench::report("delta size", delta_size / 1024.0, "KiB");
+
+	std::vector<uint8_t> rebuilt(target.size());
+	t = bench::measure([&] {
+		yks::applySnapshotDelta(base.data(), base.size(), delta.data(), delta_size, rebuilt.data(), rebuilt.size());
+	});
+	bench::report("apply delta", t * 1e3, "ms");
+
+	t = bench::measure([&] {
+		yks::applySnapshotDelta(base.data(), base.size(), delta.data(), delta_size, base.data(), base.size());
+	});
+	bench::report("apply delta in place", t * 1e3, "ms");
+}
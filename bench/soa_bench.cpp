@@ -0,0 +1,80 @@
+#include "bench.hpp"
+#include "memory/ObjectPool.hpp"
+#include "memory/SoaPool.hpp"
+#include "math/vec.hpp"
+#include <vector>
+
+namespace {
+
+	struct Particle {
+		yks::vec3 pos;
+		yks::vec3 vel;
+		float color[4];
+		float life;
+		float size;
+		float rotation;
+		float spin;
+		float age;
+		float padding[3];
+	};
+
+	enum ParticleField { POS, VEL, COLOR, LIFE };
+
+	typedef yks::SoaPool<yks::vec3, yks::vec3, yks::vec4, float> ParticleSoa;
+
+}
+
+BENCHMARK(soa_pool_vs_object_pool) {
+	static const size_t NUM_PARTICLES = 1 << 20;
+
+	yks::ObjectPool<Particle> aos;
+	ParticleSoa soa;
+	soa.reserve(NUM_PARTICLES);
+	for (size_t i = 0; i < NUM_PARTICLES; ++i) {
+		const float f = float(i);
+		Particle p = {};
+		p.pos = yks::mvec3(f, f, f);
+		p.vel = yks::mvec3(1.0f, 2.0f, 3.0f);
+		p.life = f;
+		aos.emplace(p);
+		soa.insert(p.pos, p.vel, yks::mvec4(1.0f, 1.0f, 1.0f, 1.0f), p.life);
+	}
+
+	// Reads only positions
+	double t = bench::measure([&] {
+		float sum = 0.0f;
+		for (const Particle& p : aos.objects()) {
+			sum += p.pos[0] + p.pos[1] + p.pos[2];
+		}
+		bench::doNotOptimize(sum);
+	});
+	bench::report("sum positions, ObjectPool", t * 1e3, "ms");
+
+	t = bench::measure([&] {
+		float sum = 0.0f;
+		for (const yks::vec3& pos : soa.field<POS>()) {
+			sum += pos[0] + pos[1] + pos[2];
+		}
+		bench::doNotOptimize(sum);
+	});
+	bench::report("sum positions, SoaPool", t * 1e3, "ms");
+
+	// Reads velocities and updates positions
+	t = bench::measure([&] {
+		for (Particle& p : aos.objects()) {
+			p.pos = p.pos + p.vel * 0.016f;
+		}
+		bench::doNotOptimize(aos.pool.data());
+	});
+	bench::report("integrate, ObjectPool", t * 1e3, "ms");
+
+	t = bench::measure([&] {
+		yks::Span<yks::vec3> pos = soa.field<POS>();
+		yks::Span<const yks::vec3> vel = soa.field<VEL>();
+		for (size_t i = 0; i < pos.size(); ++i) {
+			pos[i] = pos[i] + vel[i] * 0.016f;
+		}
+		bench::doNotOptimize(pos.data());
+	});
+	bench::report("integrate, SoaPool", t * 1e3, "ms");
+}
@@ -0,0 +1,110 @@
+#include "bench.hpp"
+#include "SortedVector.hpp"
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+	typedef std::pair<uint32_t, uint32_t> Entry;
+
+	std::vector<Entry> makeEntries(size_t n) {
+		std::mt19937 rng(42);
+		std::vector<Entry> entries(n);
+		for (size_t i = 0; i < n; ++i) {
+			entries[i] = Entry(uint32_t(rng()), uint32_t(i));
+		}
+		return entries;
+	}
+
+}
+
+BENCHMARK(sorted_vector_build) {
+	static const size_t SMALL = 1 << 15;
+	static const size_t LARGE = 1 << 20;
+
+	const std::vector<Entry> entries = makeEntries(LARGE);
+
+	// One at a time is quadratic, so only try it on a smaller table
+	double t = bench::measure([&] {
+		SortedVector<Entry> sv;
+		for (size_t i = 0; i < SMALL; ++i) {
+			sv.insert(entries[i]);
+		}
+		bench::doNotOptimize(sv.data.data());
+	}, 3);
+	bench::report("insert one at a time, 32K", t * 1e3, "ms");
+
+	t = bench::measure([&] {
+		SortedVector<Entry> sv;
+		sv.insertBulk(yks::Span<const Entry>(entries.data(), SMALL));
+		bench::doNotOptimize(sv.data.data());
+	});
+	bench::report("insertBulk, 32K", t * 1e3, "ms");
+
+	t = bench::measure([&] {
+		SortedVector<Entry> sv;
+		sv.insertBulk(entries);
+		bench::doNotOptimize(sv.data.data());
+	});
+	bench::report("insertBulk, 1M", t * 1e3, "ms");
+
+	// Merging a small batch into an existing table
+	SortedVector<Entry> base;
+	base.insertBulk(yks::Span<const Entry>(entries.data(), LARGE - 1024));
+	t = bench::measure([&] {
+		SortedVector<Entry> sv = base;
+		sv.insertBulk(yks::Span<const Entry>(entries.data() + LARGE - 1024, 1024));
+		bench::doNotOptimize(sv.data.data());
+	});
+	bench::report("copy + insertBulk 1K into 1M", t * 1e3, "ms");
+}
+
+BENCHMARK(sorted_vector_lookup) {
+	for (const size_t n : { size_t(1) << 12, size_t(1) << 16, size_t(1) << 20, size_t(1) << 23 }) {
+		const std::vector<Entry> entries = makeEntries(n);
+		SortedVector<Entry> sv;
+		sv.insertBulk(entries);
+		const FrozenSortedVector<Entry> frozen(sv);
+
+		// Half of the queries hit
+		static const size_t NUM_QUERIES = 1 << 20;
+		std::mt19937 rng(7);
+		std::vector<uint32_t> queries(NUM_QUERIES);
+		for (uint32_t& q : queries) {
+			q = rng() & 1 ? entries[rng() % n].first : uint32_t(rng());
+		}
+
+		char metric[64];
+
+		double t = bench::measure([&] {
+			uint32_t sum = 0;
+			for (const uint32_t q : queries) {
+				auto it = sv.lookup(q);
+				if (it != sv.data.end()) sum += it->second;
+			}
+			bench::doNotOptimize(sum);
+		});
+		std::snprintf(metric, sizeof(metric), "binary search, n=%zu", n);
+		bench::report(metric, t * 1e9 / NUM_QUERIES, "ns");
+
+		t = bench::measure([&] {
+			uint32_t sum = 0;
+			for (const uint32_t q : queries) {
+				if (const Entry* e = frozen.lookup(q)) sum += e->second;
+			}
+			bench::doNotOptimize(sum);
+		});
+		std::snprintf(metric, sizeof(metric), "eytzinger, n=%zu", n);
+		bench::report(metric, t * 1e9 / NUM_QUERIES, "ns");
+
+		std::vector<const Entry*> results(NUM_QUERIES);
+		t = bench::measure([&] {
+			frozen.lookupBatch(queries, results.data());
+			bench::doNotOptimize(results.data());
+		});
+		std::snprintf(metric, sizeof(metric), "eytzinger batch, n=%zu", n);
+		bench::report(metric, t * 1e9 / NUM_QUERIES, "ns");
+	}
+}
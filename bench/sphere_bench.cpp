@@ -0,0 +1,262 @@
+#include "bench.hpp"
+#include "math/Sphere.hpp"
+#include "math/SphereBvh.hpp"
+#include "math/SphereSampling.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	static const size_t NUM_SPHERES = 10000;
+	static const size_t NUM_RAYS = 1 << 16;
+	// Testing every sphere is slow, so it only gets some of the rays
+	static const size_t NUM_BRUTE_FORCE_RAYS = 512;
+
+	struct Scene {
+		std::vector<yks::vec3> centers;
+		std::vector<float> radii;
+		std::vector<float> center_x, center_y, center_z;
+		std::vector<yks::Ray> rays;
+	};
+
+	Scene makeScene() {
+		std::mt19937 rng(13);
+		std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> size(0.2f, 2.0f);
+
+		Scene scene;
+		for (size_t i = 0; i < NUM_SPHERES; ++i) {
+			const yks::vec3 c = yks::mvec3(pos(rng), pos(rng), pos(rng));
+			scene.centers.push_back(c);
+			scene.radii.push_back(size(rng));
+			scene.center_x.push_back(c[0]);
+			scene.center_y.push_back(c[1]);
+			scene.center_z.push_back(c[2]);
+		}
+
+		// From outside the spheres towards points inside them, like picking
+		// from a camera
+		for (size_t i = 0; i < NUM_RAYS; ++i) {
+			const yks::vec3 origin = yks::mvec3(pos(rng), pos(rng), -150.0f);
+			const yks::vec3 target = yks::mvec3(pos(rng), pos(rng), pos(rng));
+			scene.rays.push_back(yks::Ray{ origin, target - origin });
+		}
+		return scene;
+	}
+
+	/** Nearest sphere hit by r, testing every sphere with
+	 * intersect_with_sphere. sphere is SphereHit::NONE if none is hit. */
+	yks::SphereHit bruteForceHit(const Scene& scene, const yks::Ray& r) {
+		yks::SphereHit best = { yks::SphereHit::NONE, 0.0f };
+		for (size_t j = 0; j < scene.centers.size(); ++j) {
+			const yks::Optional<float> hit = yks::intersect_with_sphere(scene.centers[j], scene.radii[j], r);
+			if (hit && (best.sphere == yks::SphereHit::NONE || *hit < best.t)) {
+				best.sphere = uint32_t(j);
+				best.t = *hit;
+			}
+		}
+		return best;
+	}
+
+	/** Checks that a and b hit the same sphere, at about the same distance.
+	 * With -ffast-math the compiler orders the arithmetic differently in
+	 * each version, and rays grazing a sphere lose about half of the bits of
+	 * t to that, so distances only have to match to 1e-3. */
+	/** Points written by the batch sampling functions, with a sentinel after
+	 * the last one to catch writes past the end. */
+	struct SampledPoints {
+		static constexpr float SENTINEL = 42.0f;
+
+		std::vector<float> x, y, z;
+
+		explicit SampledPoints(size_t count)
+			: x(count + 1, SENTINEL), y(count + 1, SENTINEL), z(count + 1, SENTINEL)
+		{}
+
+		size_t size() const { return x.size() - 1; }
+
+		bool onSphere(bool hemisphere) const {
+			for (size_t i = 0; i < size(); ++i) {
+				const double len_sqr = double(x[i]) * x[i] + double(y[i]) * y[i] + double(z[i]) * z[i];
+				if (!(std::abs(len_sqr - 1.0) <= 1e-5) || (hemisphere && !(y[i] >= 0.0f)))
+					return false;
+			}
+			return x.back() == SENTINEL && y.back() == SENTINEL && z.back() == SENTINEL;
+		}
+
+		bool operator==(const SampledPoints& o) const { return x == o.x && y == o.y && z == o.z; }
+
+		/** Number of points also in o at the same index. */
+		size_t numShared(const SampledPoints& o) const {
+			size_t n = 0;
+			for (size_t i = 0; i < size(); ++i) {
+				n += x[i] == o.x[i] && y[i] == o.y[i] && z[i] == o.z[i];
+			}
+			return n;
+		}
+	};
+
+	bool sameHit(const yks::SphereHit& a, const yks::SphereHit& b) {
+		return a.sphere == b.sphere &&
+			(a.sphere == yks::SphereHit::NONE || std::abs(a.t - b.t) <= 1e-3f * b.t);
+	}
+
+}
+
+BENCHMARK(sphere_intersection) {
+	const Scene scene = makeScene();
+
+	std::vector<float> out(NUM_RAYS);
+	double t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_BRUTE_FORCE_RAYS; ++i) {
+			float best = -1.0f;
+			for (size_t j = 0; j < NUM_SPHERES; ++j) {
+				const yks::Optional<float> hit = yks::intersect_with_sphere(scene.centers[j], scene.radii[j], scene.rays[i]);
+				if (hit && (best < 0.0f || *hit < best)) {
+					best = *hit;
+				}
+			}
+			out[i] = best;
+		}
+		bench::doNotOptimize(out.data());
+	}, 2);
+	bench::report("intersect_with_sphere, all spheres", NUM_BRUTE_FORCE_RAYS / t * 1e-6, "Mrays/s");
+
+	t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_BRUTE_FORCE_RAYS; ++i) {
+			yks::intersect_with_spheres(scene.center_x.data(), scene.center_y.data(), scene.center_z.data(),
+				scene.radii.data(), NUM_SPHERES, scene.rays[i], out[i]);
+		}
+		bench::doNotOptimize(out.data());
+	}, 2);
+	bench::report("intersect_with_spheres, all spheres", NUM_BRUTE_FORCE_RAYS / t * 1e-6, "Mrays/s");
+
+	// Everything below must find the same hits as the brute force loop
+	std::vector<yks::SphereHit> expected(NUM_BRUTE_FORCE_RAYS);
+	for (size_t i = 0; i < NUM_BRUTE_FORCE_RAYS; ++i) {
+		expected[i] = bruteForceHit(scene, scene.rays[i]);
+	}
+
+	bool same = true;
+	for (size_t i = 0; i < NUM_BRUTE_FORCE_RAYS; ++i) {
+		float hit_t = 0.0f;
+		const size_t sphere = yks::intersect_with_spheres(scene.center_x.data(), scene.center_y.data(), scene.center_z.data(),
+			scene.radii.data(), NUM_SPHERES, scene.rays[i], hit_t);
+		const yks::SphereHit hit = { sphere == SIZE_MAX ? yks::SphereHit::NONE : uint32_t(sphere), hit_t };
+		same = same && sameHit(hit, expected[i]);
+	}
+	bench::check(same, "intersect_with_spheres differs from intersect_with_sphere");
+
+	yks::SphereBvh bvh;
+	t = bench::measure([&] {
+		bvh.build(scene.centers, scene.radii);
+	});
+	bench::report("SphereBvh::build", t * 1e3, "ms");
+
+	same = true;
+	for (size_t i = 0; i < NUM_BRUTE_FORCE_RAYS; ++i) {
+		const yks::Optional<yks::SphereHit> hit = bvh.intersect(scene.rays[i]);
+		same = same && sameHit(hit ? *hit : yks::SphereHit{ yks::SphereHit::NONE, 0.0f }, expected[i]);
+	}
+	bench::check(same, "SphereBvh::intersect differs from intersect_with_sphere");
+
+	std::vector<yks::SphereHit> hits(NUM_RAYS);
+	const unsigned int max_threads = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+		t = bench::measure([&] {
+			bvh.intersect(scene.rays, hits, num_threads);
+			bench::doNotOptimize(hits.data());
+		});
+		char metric[64];
+		std::snprintf(metric, sizeof(metric), "SphereBvh::intersect, %u threads", num_threads);
+		bench::report(metric, NUM_RAYS / t * 1e-6, "Mrays/s");
+
+		same = true;
+		for (size_t i = 0; i < NUM_BRUTE_FORCE_RAYS; ++i) {
+			same = same && sameHit(hits[i], expected[i]);
+		}
+		std::snprintf(metric, sizeof(metric), "SphereBvh::intersect, %u threads, differs", num_threads);
+		bench::check(same, metric);
+	}
+
+	// Also split the batch on machines with few cores
+	std::fill(hits.begin(), hits.end(), yks::SphereHit{ yks::SphereHit::NONE, 0.0f });
+	bvh.intersect(scene.rays, hits, 4);
+	same = true;
+	for (size_t i = 0; i < NUM_BRUTE_FORCE_RAYS; ++i) {
+		same = same && sameHit(hits[i], expected[i]);
+	}
+	bench::check(same, "SphereBvh::intersect, 4 threads, differs");
+}
+
+BENCHMARK(sphere_sampling) {
+	static const size_t NUM_POINTS = 1 << 16;
+
+	std::vector<yks::vec3> points(NUM_POINTS);
+	std::vector<float> x(NUM_POINTS), y(NUM_POINTS), z(NUM_POINTS);
+
+	std::mt19937 rng(14);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	double t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_POINTS; ++i) {
+			const float a = unit(rng);
+			const float b = unit(rng);
+			points[i] = yks::uniform_point_on_sphere(a, b);
+		}
+		bench::doNotOptimize(points.data());
+	});
+	bench::report("uniform_point_on_sphere, mt19937", NUM_POINTS / t * 1e-6, "Mpoints/s");
+
+	yks::SampleRng sample_rng(14);
+	t = bench::measure([&] {
+		yks::random_points_on_sphere(sample_rng, NUM_POINTS, x.data(), y.data(), z.data());
+		bench::doNotOptimize(x.data());
+	});
+	bench::report("random_points_on_sphere", NUM_POINTS / t * 1e-6, "Mpoints/s");
+
+	t = bench::measure([&] {
+		yks::r2_points_on_sphere(0, NUM_POINTS, x.data(), y.data(), z.data());
+		bench::doNotOptimize(x.data());
+	});
+	bench::report("r2_points_on_sphere", NUM_POINTS / t * 1e-6, "Mpoints/s");
+
+	// Not a multiple of 4, so that the tail is covered too
+	static const size_t NUM_CHECKED = 1001;
+	for (bool hemisphere : { false, true }) {
+		const char* const shape = hemisphere ? "hemisphere" : "sphere";
+		char what[96];
+
+		yks::SampleRng rng(15), scalar_rng(15);
+		SampledPoints random(NUM_CHECKED), scalar_random(NUM_CHECKED);
+		(hemisphere ? yks::random_points_on_hemisphere : yks::random_points_on_sphere)(
+			rng, NUM_CHECKED, random.x.data(), random.y.data(), random.z.data());
+		yks::sampling_detail::random_points_scalar(scalar_rng, hemisphere, NUM_CHECKED,
+			scalar_random.x.data(), scalar_random.y.data(), scalar_random.z.data());
+		std::snprintf(what, sizeof(what), "random points not on the unit %s", shape);
+		bench::check(random.onSphere(hemisphere), what);
+		std::snprintf(what, sizeof(what), "random points on the %s differ from the scalar version", shape);
+		bench::check(random == scalar_random && std::memcmp(rng.state, scalar_rng.state, sizeof(rng.state)) == 0, what);
+
+		SampledPoints r2(NUM_CHECKED), scalar_r2(NUM_CHECKED);
+		(hemisphere ? yks::r2_points_on_hemisphere : yks::r2_points_on_sphere)(
+			5, NUM_CHECKED, r2.x.data(), r2.y.data(), r2.z.data());
+		yks::sampling_detail::r2_points_scalar(5, hemisphere, NUM_CHECKED, scalar_r2.x.data(), scalar_r2.y.data(), scalar_r2.z.data());
+		std::snprintf(what, sizeof(what), "R2 points not on the unit %s", shape);
+		bench::check(r2.onSphere(hemisphere), what);
+		std::snprintf(what, sizeof(what), "R2 points on the %s differ from the scalar version", shape);
+		bench::check(r2 == scalar_r2, what);
+	}
+
+	// Other streams of the same seed must give other points
+	yks::SampleRng stream0(15, 0), stream1(15, 1);
+	SampledPoints points0(NUM_CHECKED), points1(NUM_CHECKED);
+	yks::random_points_on_sphere(stream0, NUM_CHECKED, points0.x.data(), points0.y.data(), points0.z.data());
+	yks::random_points_on_sphere(stream1, NUM_CHECKED, points1.x.data(), points1.y.data(), points1.z.data());
+	bench::check(points0.numShared(points1) == 0, "streams 0 and 1 share points");
+}
@@ -0,0 +1,216 @@
+#include "bench.hpp"
+#include "gl/gl_1_5.h"
+#include "render/SpriteBatch.hpp"
+#include "render/SpriteBuffer.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+	static const size_t NUM_ITEMS = 1 << 16;
+
+	yks::SpriteMatrix randomSpriteMatrix(std::mt19937& rng) {
+		std::uniform_real_distribution<float> angle(0.0f, 6.28f);
+		std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+		std::uniform_real_distribution<float> pos(0.0f, 1000.0f);
+		yks::SpriteMatrix m;
+		m.rotate(angle(rng))
+			.scale(yks::mvec2(scale(rng), scale(rng)))
+			.translate(yks::mvec2(pos(rng), pos(rng)));
+		return m;
+	}
+
+	// SpriteBuffer only needs GL for the name of its vertex buffer, which
+	// appending never touches, so these stand in for a context.
+	void CODEGEN_FUNCPTR fakeGenBuffers(GLsizei n, GLuint* names) {
+		for (GLsizei i = 0; i < n; ++i) {
+			names[i] = GLuint(i + 1);
+		}
+	}
+
+	void CODEGEN_FUNCPTR fakeDeleteBuffers(GLsizei, const GLuint*) {}
+
+}
+
+BENCHMARK(sprite_batch) {
+	std::printf("  using %s\n", yks::getSpriteBatchIsa());
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+	std::vector<yks::SpriteMatrix> mats(NUM_ITEMS);
+	yks::SpriteMatrixArray mat_array;
+	mat_array.resize(NUM_ITEMS);
+	std::vector<float> xs(NUM_ITEMS), ys(NUM_ITEMS);
+	for (size_t i = 0; i < NUM_ITEMS; ++i) {
+		mats[i] = randomSpriteMatrix(rng);
+		mat_array.set(i, mats[i]);
+		xs[i] = dist(rng);
+		ys[i] = dist(rng);
+	}
+
+	std::vector<yks::vec2> out_points(NUM_ITEMS);
+	std::vector<float> out_x(NUM_ITEMS), out_y(NUM_ITEMS);
+
+	double t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_ITEMS; ++i) {
+			out_points[i] = mats[0].transform(yks::mvec2(xs[i], ys[i]));
+		}
+		bench::doNotOptimize(out_points.data());
+	});
+	bench::report("one matrix, SpriteMatrix::transform", t * 1e9 / NUM_ITEMS, "ns");
+
+	t = bench::measure([&] {
+		yks::transformPoints(mats[0], xs.data(), ys.data(), out_x.data(), out_y.data(), NUM_ITEMS);
+		bench::doNotOptimize(out_x.data());
+	});
+	bench::report("one matrix, transformPoints", t * 1e9 / NUM_ITEMS, "ns");
+
+	t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_ITEMS; ++i) {
+			out_points[i] = mats[i].transform(yks::mvec2(xs[i], ys[i]));
+		}
+		bench::doNotOptimize(out_points.data());
+	});
+	bench::report("many matrices, SpriteMatrix::transform", t * 1e9 / NUM_ITEMS, "ns");
+
+	t = bench::measure([&] {
+		yks::transformPoints(mat_array, xs.data(), ys.data(), out_x.data(), out_y.data());
+		bench::doNotOptimize(out_x.data());
+	});
+	bench::report("many matrices, transformPoints", t * 1e9 / NUM_ITEMS, "ns");
+
+	std::vector<yks::SpriteMatrix> out_mats(NUM_ITEMS);
+	t = bench::measure([&] {
+		for (size_t i = 0; i + 1 < NUM_ITEMS; ++i) {
+			out_mats[i] = mats[i];
+			out_mats[i].multiply(mats[i + 1]);
+		}
+		bench::doNotOptimize(out_mats.data());
+	});
+	bench::report("multiply, SpriteMatrix", t * 1e9 / NUM_ITEMS, "ns");
+
+	yks::SpriteMatrixArray out_array;
+	t = bench::measure([&] {
+		out_array = mat_array;
+		yks::multiplyMatrices(out_array, mat_array);
+		bench::doNotOptimize(out_array.m[0][0].data());
+	});
+	bench::report("multiply, multiplyMatrices (with copy)", t * 1e9 / NUM_ITEMS, "ns");
+
+	t = bench::measure([&] {
+		for (size_t i = 0; i < NUM_ITEMS; ++i) {
+			out_mats[i] = mats[i].inverse();
+		}
+		bench::doNotOptimize(out_mats.data());
+	});
+	bench::report("invert, SpriteMatrix", t * 1e9 / NUM_ITEMS, "ns");
+
+	t = bench::measure([&] {
+		out_array = mat_array;
+		yks::invertMatrices(out_array);
+		bench::doNotOptimize(out_array.m[0][0].data());
+	});
+	bench::report("invert, invertMatrices (with copy)", t * 1e9 / NUM_ITEMS, "ns");
+}
+
+BENCHMARK(sprite_hit_test) {
+	static const size_t NUM_SPRITES = 4096;
+	static const size_t NUM_QUERIES = 1024;
+
+	std::mt19937 rng(8);
+	std::vector<yks::Sprite> sprites(NUM_SPRITES);
+	for (yks::Sprite& spr : sprites) {
+		spr.mat = randomSpriteMatrix(rng);
+		spr.img = yks::IntRect{ 0, 0, 32, 48 };
+	}
+	std::uniform_real_distribution<float> dist(0.0f, 1000.0f);
+	std::vector<yks::vec2> queries(NUM_QUERIES);
+	for (yks::vec2& q : queries) {
+		q = yks::mvec2(dist(rng), dist(rng));
+	}
+
+	std::vector<size_t> found(NUM_QUERIES);
+	double t = bench::measure([&] {
+		for (size_t q = 0; q < NUM_QUERIES; ++q) {
+			found[q] = SIZE_MAX;
+			for (size_t k = NUM_SPRITES; k-- > 0; ) {
+				const yks::vec2 p = sprites[k].mat.inverse().transform(queries[q]);
+				if (p[0] >= 0.0f && p[0] < 32.0f && p[1] >= 0.0f && p[1] < 48.0f) {
+					found[q] = k;
+					break;
+				}
+			}
+		}
+		bench::doNotOptimize(found.data());
+	});
+	bench::report("scalar inverse per query", t * 1e9 / NUM_QUERIES, "ns");
+
+	yks::SpriteHitTester tester;
+	t = bench::measure([&] {
+		tester.build(sprites);
+	});
+	bench::report("SpriteHitTester::build", t * 1e9, "ns");
+
+	t = bench::measure([&] {
+		for (size_t q = 0; q < NUM_QUERIES; ++q) {
+			found[q] = tester.find(queries[q]);
+		}
+		bench::doNotOptimize(found.data());
+	});
+	bench::report("SpriteHitTester::find", t * 1e9 / NUM_QUERIES, "ns");
+}
+
+BENCHMARK(sprite_buffer_append) {
+	static const size_t sizes[] = { 64, 4096 };
+
+	if (glGenBuffers == nullptr) {
+		_ptrc_glGenBuffers = &fakeGenBuffers;
+		_ptrc_glDeleteBuffers = &fakeDeleteBuffers;
+	}
+
+	std::mt19937 rng(9);
+	for (const size_t n : sizes) {
+		std::vector<yks::Sprite> sprites(n);
+		std::vector<yks::UvRect> uvs(n);
+		for (size_t i = 0; i < n; ++i) {
+			sprites[i].mat = randomSpriteMatrix(rng);
+			sprites[i].img = yks::IntRect{ 0, 0, 32, 48 };
+			uvs[i] = yks::UvRect{ 0.0f, 0.0f, 0.25f, 0.5f };
+		}
+
+		// Enough repetitions for the small batch to take measurable time
+		const size_t reps = 65536 / n;
+		yks::SpriteBuffer buffer;
+		char metric[64];
+
+		double t = bench::measure([&] {
+			for (size_t r = 0; r < reps; ++r) {
+				buffer.clear();
+				for (size_t i = 0; i < n; ++i) {
+					buffer.append(sprites[i], uvs[i]);
+				}
+			}
+			bench::doNotOptimize(buffer.vertices.data());
+		});
+		std::snprintf(metric, sizeof(metric), "one at a time, n=%zu", n);
+		bench::report(metric, t * 1e9 / (reps * n), "ns/sprite");
+		const std::vector<yks::VertexData> one_at_a_time = buffer.vertices;
+
+		t = bench::measure([&] {
+			for (size_t r = 0; r < reps; ++r) {
+				buffer.clear();
+				buffer.append(sprites, uvs);
+			}
+			bench::doNotOptimize(buffer.vertices.data());
+		});
+		std::snprintf(metric, sizeof(metric), "batched, n=%zu", n);
+		bench::report(metric, t * 1e9 / (reps * n), "ns/sprite");
+
+		bench::check(buffer.vertices.size() == one_at_a_time.size() &&
+			std::memcmp(buffer.vertices.data(), one_at_a_time.data(), one_at_a_time.size() * sizeof(yks::VertexData)) == 0,
+			"batched append differs from one at a time");
+	}
+}
@@ -0,0 +1,101 @@
+#include "bench.hpp"
+#include "render/text.hpp"
+#include <string>
+#include <vector>
+
+BENCHMARK(text_scoreboard) {
+	static const int NUM_LABELS = 5000;
+	static const int NUM_FRAMES = 20;
+
+	const yks::FontInfo font(' ', 8, 8, 0, 0, 16, 6);
+	const yks::vec2i texture_size = { { 256, 256 } };
+
+	std::vector<std::string> labels;
+	for (int i = 0; i < NUM_LABELS; ++i) {
+		labels.push_back("PLAYER " + std::to_string(i) + ": " + std::to_string(i * 7919 % 100000));
+	}
+
+	std::vector<yks::VertexData> vertices;
+
+	double t = bench::measure([&] {
+		for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+			vertices.clear();
+			for (int i = 0; i < NUM_LABELS; ++i) {
+				yks::layoutString(yks::mvec2(float(i % 10 * 36), float(i / 10 * 10)),
+					labels[i], font, yks::color_white, texture_size, vertices);
+			}
+			bench::doNotOptimize(vertices.data());
+		}
+	});
+	bench::report("layout every frame", t / NUM_FRAMES * 1e6, "us/frame");
+
+	yks::TextCache cache;
+	t = bench::measure([&] {
+		for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+			vertices.clear();
+			for (int i = 0; i < NUM_LABELS; ++i) {
+				yks::appendTranslatedVertices(vertices,
+					cache.getRun(labels[i], font, yks::color_white, texture_size),
+					yks::mvec2(float(i % 10 * 36), float(i / 10 * 10)));
+			}
+			cache.nextFrame();
+			bench::doNotOptimize(vertices.data());
+		}
+	});
+	bench::report("TextCache", t / NUM_FRAMES * 1e6, "us/frame");
+}
+
+BENCHMARK(text_wrap_proportional) {
+	static const int NUM_PARAGRAPHS = 2000;
+	static const int NUM_FRAMES = 20;
+
+	yks::FontInfo font(' ', 8, 8, 0, 0, 16, 6);
+	int advances[16 * 6];
+	for (int i = 0; i < 16 * 6; ++i) {
+		advances[i] = 3 + i * 5 % 6;
+	}
+	font.setAdvances(advances, 16 * 6);
+	font.setKerning('A', 'V', -1);
+	font.setKerning('V', 'A', -1);
+
+	std::vector<std::string> paragraphs;
+	for (int i = 0; i < NUM_PARAGRAPHS; ++i) {
+		paragraphs.push_back("VALUE " + std::to_string(i) + " OF THE CARD PAIR GRANTS A BONUS WHEN MATCHED IN A ROW.\nAVOID MISSES TO KEEP THE COMBO GOING.");
+	}
+
+	int total_width = 0;
+	double t = bench::measure([&] {
+		for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+			for (const std::string& p : paragraphs) {
+				total_width += yks::measureStringWidth(p, font);
+			}
+		}
+		bench::doNotOptimize(total_width);
+	});
+	bench::report("measure", t / NUM_FRAMES * 1e6, "us/frame");
+
+	yks::TextLine lines[16];
+	size_t total_lines = 0;
+	t = bench::measure([&] {
+		for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+			for (const std::string& p : paragraphs) {
+				total_lines += yks::breakTextLines(p, font, 160, lines, 16);
+			}
+		}
+		bench::doNotOptimize(total_lines);
+	});
+	bench::report("break lines", t / NUM_FRAMES * 1e6, "us/frame");
+
+	const yks::vec2i texture_size = { { 256, 256 } };
+	std::vector<yks::VertexData> vertices;
+	t = bench::measure([&] {
+		for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+			vertices.clear();
+			for (const std::string& p : paragraphs) {
+				yks::layoutWrappedText(yks::mvec2(0.0f, 0.0f), p, font, 160, 10, yks::color_white, texture_size, vertices);
+			}
+			bench::doNotOptimize(vertices.data());
+		}
+	});
+	bench::report("layout wrapped", t / NUM_FRAMES * 1e6, "us/frame");
+}
@@ -0,0 +1,207 @@
+#include "AssetWatcher.hpp"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace yks {
+
+	struct AssetWatcher::Impl {
+		std::mutex mutex;
+		// Guarded by mutex
+		std::unordered_map<std::string, ReloadFn> watches;
+		std::vector<ApplyFn> pending_changes;
+
+#ifdef __linux__
+		int inotify_fd = -1;
+		int quit_pipe[2] = { -1, -1 };
+		std::thread worker;
+
+		// Guarded by mutex
+		std::unordered_map<int, std::string> dirs_by_wd;
+		std::unordered_map<std::string, int> wds_by_dir;
+
+		Impl() {
+			inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (inotify_fd == -1)
+				return;
+
+			if (pipe(quit_pipe) != 0) {
+				close(inotify_fd);
+				inotify_fd = -1;
+				return;
+			}
+
+			worker = std::thread([this] { run(); });
+		}
+
+		~Impl() {
+			if (worker.joinable()) {
+				const char quit = 0;
+				while (write(quit_pipe[1], &quit, 1) == -1 && errno == EINTR) {}
+				worker.join();
+			}
+			if (quit_pipe[0] != -1) close(quit_pipe[0]);
+			if (quit_pipe[1] != -1) close(quit_pipe[1]);
+			if (inotify_fd != -1) close(inotify_fd);
+		}
+
+		bool isSupported() const {
+			return inotify_fd != -1;
+		}
+
+		static std::string dirOf(const std::string& filename) {
+			const std::string::size_type slash = filename.rfind('/');
+			if (slash == std::string::npos)
+				return ".";
+			return filename.substr(0, slash == 0 ? 1 : slash);
+		}
+
+		static std::string joinPath(const std::string& dir, const char* name) {
+			if (dir == ".")
+				return name;
+			if (dir == "/")
+				return dir + name;
+			return dir + '/' + name;
+		}
+
+		// Must be called with mutex held.
+		void watchDir(const std::string& filename) {
+			if (!isSupported())
+				return;
+
+			// Directories are watched instead of files since editors often
+			// save by replacing the file, which would drop a watch on it.
+			const std::string dir = dirOf(filename);
+			if (wds_by_dir.count(dir) != 0)
+				return;
+
+			const int wd = inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+			if (wd != -1) {
+				wds_by_dir.emplace(dir, wd);
+				dirs_by_wd.emplace(wd, dir);
+			}
+		}
+
+		void readEvents(std::vector<std::string>& changed_files) {
+			alignas(inotify_event) char buffer[4096];
+
+			for (;;) {
+				const ssize_t len = read(inotify_fd, buffer, sizeof(buffer));
+				if (len <= 0)
+					return;
+
+				std::lock_guard<std::mutex> lock(mutex);
+				for (const char* p = buffer; p < buffer + len; ) {
+					const inotify_event* ev = reinterpret_cast<const inotify_event*>(p);
+					p += sizeof(inotify_event) + ev->len;
+
+					auto dir = dirs_by_wd.find(ev->wd);
+					if (ev->len == 0 || dir == dirs_by_wd.end())
+						continue;
+
+					std::string filename = joinPath(dir->second, ev->name);
+					if (watches.count(filename) != 0) {
+						changed_files.push_back(std::move(filename));
+					}
+				}
+			}
+		}
+
+		void run() {
+			static const int SETTLE_TIME_MS = 50;
+
+			std::vector<std::string> changed_files;
+			for (;;) {
+				pollfd fds[2] = {
+					{ inotify_fd, POLLIN, 0 },
+					{ quit_pipe[0], POLLIN, 0 },
+				};
+				if (poll(fds, 2, -1) < 0)
+					continue;
+				if (fds[1].revents != 0)
+					return;
+
+				// Editors often save in several steps, so give them some
+				// time to finish before reading anything.
+				readEvents(changed_files);
+				while (poll(fds, 1, SETTLE_TIME_MS) > 0) {
+					readEvents(changed_files);
+				}
+
+				std::sort(changed_files.begin(), changed_files.end());
+				changed_files.erase(std::unique(changed_files.begin(), changed_files.end()), changed_files.end());
+
+				for (const std::string& filename : changed_files) {
+					ReloadFn reload;
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						auto i = watches.find(filename);
+						if (i == watches.end())
+							continue;
+						reload = i->second;
+					}
+
+					ApplyFn apply = reload(filename);
+					if (apply) {
+						std::lock_guard<std::mutex> lock(mutex);
+						pending_changes.push_back(std::move(apply));
+					}
+				}
+				changed_files.clear();
+			}
+		}
+#else
+		bool isSupported() const {
+			return false;
+		}
+
+		void watchDir(const std::string&) {}
+#endif
+	};
+
+	AssetWatcher::AssetWatcher()
+		: impl(new Impl)
+	{}
+
+	AssetWatcher::~AssetWatcher() {}
+
+	bool AssetWatcher::isSupported() const {
+		return impl->isSupported();
+	}
+
+	void AssetWatcher::watch(const std::string& filename, ReloadFn reload) {
+		std::lock_guard<std::mutex> lock(impl->mutex);
+		impl->watches[filename] = std::move(reload);
+		impl->watchDir(filename);
+	}
+
+	void AssetWatcher::unwatch(const std::string& filename) {
+		std::lock_guard<std::mutex> lock(impl->mutex);
+		impl->watches.erase(filename);
+	}
+
+	size_t AssetWatcher::applyPendingChanges() {
+		std::vector<ApplyFn> changes;
+		{
+			std::lock_guard<std::mutex> lock(impl->mutex);
+			if (impl->pending_changes.empty())
+				return 0;
+			changes.swap(impl->pending_changes);
+		}
+
+		for (const ApplyFn& apply : changes) {
+			apply();
+		}
+		return changes.size();
+	}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "noncopyable.hpp"
+
+namespace yks {
+
+	/** Watches asset files for changes, reloading them in the background.
+	 *
+	 * Reloading is split in two steps: a reload function, which runs on a
+	 * worker thread and should do all the expensive work (reading and decoding
+	 * the file), and the apply function it returns, which runs on the thread
+	 * calling applyPendingChanges() and should only swap in the new data.
+	 *
+	 * Currently only implemented on Linux, using inotify. On other platforms
+	 * watches are accepted but never trigger. */
+	struct AssetWatcher {
+		typedef std::function<void()> ApplyFn;
+		typedef std::function<ApplyFn(const std::string& filename)> ReloadFn;
+
+		AssetWatcher();
+		~AssetWatcher();
+
+		/** Returns false if file watching isn't available on this platform. */
+		bool isSupported() const;
+
+		/** Starts watching filename, replacing any previous watch on it. */
+		void watch(const std::string& filename, ReloadFn reload);
+		void unwatch(const std::string& filename);
+
+		/** Calls the apply functions for all reloads finished since the last
+		 * call. Returns the number of assets that were updated. */
+		size_t applyPendingChanges();
+
+	private:
+		struct Impl;
+		std::unique_ptr<Impl> impl;
+
+		NONCOPYABLE(AssetWatcher);
+	};
+
+}
@@ -0,0 +1,368 @@
+#pragma once
+#include "simd.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace yks {
+
+	/** Default hash of FlatHashMap. Strings are hashed as string_views, so
+	 * maps with string keys can be searched without building a std::string. */
+	template <typename K>
+	struct FlatHash {
+		size_t operator() (const K& key) const { return std::hash<K>()(key); }
+	};
+
+	template <>
+	struct FlatHash<std::string> {
+		size_t operator() (std::string_view key) const { return std::hash<std::string_view>()(key); }
+	};
+
+	/** Hash map keeping its entries in a dense array, like ObjectPool, behind
+	 * an open-addressing index. Each index slot has a control byte holding 7
+	 * bits of the entry's hash, and a probe compares a whole group of 16 of
+	 * them at once before looking at any key.
+	 *
+	 * Iteration walks the dense array, so it's fast and in insertion order
+	 * until something is erased. Erasing moves the last entry into the hole,
+	 * unless StableOrder is set, in which case later entries are shifted down
+	 * instead, which is O(n).
+	 *
+	 * Like with std::vector, inserting invalidates iterators and pointers to
+	 * entries. Keys must not be modified through iterators. */
+	template <typename K, typename V, typename Hash = FlatHash<K>, bool StableOrder = false>
+	struct FlatHashMap {
+		typedef std::pair<K, V> value_type;
+		typedef value_type* iterator;
+		typedef const value_type* const_iterator;
+
+		FlatHashMap()
+			: group_mask(0), num_tombstones(0)
+		{}
+
+		size_t size() const { return entries.size(); }
+		bool empty() const { return entries.empty(); }
+
+		iterator begin() { return entries.data(); }
+		iterator end() { return entries.data() + entries.size(); }
+		const_iterator begin() const { return entries.data(); }
+		const_iterator end() const { return entries.data() + entries.size(); }
+
+		void clear() {
+			entries.clear();
+			hashes.clear();
+			std::fill(ctrl.begin(), ctrl.end(), ctrl_empty);
+			num_tombstones = 0;
+		}
+
+		/** Makes room for count entries, so inserting them doesn't rehash. */
+		void reserve(size_t count) {
+			entries.reserve(count);
+			hashes.reserve(count);
+			if (count > maxLoad(ctrl.size())) {
+				rehash(capacityFor(count));
+			}
+		}
+
+		/** Finds key, which can be of any type Hash and operator== accept,
+		 * e.g. a string_view for string keys. */
+		template <typename Q>
+		iterator find(const Q& key) {
+			const size_t slot = findSlot(key, hashKey(key));
+			return slot != npos ? &entries[slots[slot]] : end();
+		}
+
+		template <typename Q>
+		const_iterator find(const Q& key) const {
+			const size_t slot = findSlot(key, hashKey(key));
+			return slot != npos ? &entries[slots[slot]] : end();
+		}
+
+		template <typename Q>
+		size_t count(const Q& key) const {
+			return findSlot(key, hashKey(key)) != npos ? 1 : 0;
+		}
+
+		/** Like std::unordered_map::at, throws std::out_of_range if key
+		 * isn't in the map. */
+		template <typename Q>
+		V& at(const Q& key) {
+			const size_t slot = findSlot(key, hashKey(key));
+			if (slot == npos)
+				throw std::out_of_range("FlatHashMap::at: key not found");
+			return entries[slots[slot]].second;
+		}
+
+		template <typename Q>
+		const V& at(const Q& key) const {
+			const size_t slot = findSlot(key, hashKey(key));
+			if (slot == npos)
+				throw std::out_of_range("FlatHashMap::at: key not found");
+			return entries[slots[slot]].second;
+		}
+
+		/** Inserts an entry constructed from value_args, unless key is already
+		 * in the map. key is only converted to K if it's inserted. */
+		template <typename Q, typename... Args>
+		std::pair<iterator, bool> emplace(Q&& key, Args&&... value_args) {
+			const uint64_t hash = hashKey(key);
+			const size_t slot = findSlot(key, hash);
+			if (slot != npos)
+				return std::make_pair(&entries[slots[slot]], false);
+
+			prepareInsert();
+			const size_t index = entries.size();
+			entries.emplace_back(std::piecewise_construct,
+				std::forward_as_tuple(std::forward<Q>(key)),
+				std::forward_as_tuple(std::forward<Args>(value_args)...));
+			hashes.push_back(hash);
+			insertIndex(hash, index);
+
+			return std::make_pair(&entries[index], true);
+		}
+
+		std::pair<iterator, bool> insert(const value_type& value) {
+			return emplace(value.first, value.second);
+		}
+
+		template <typename Q>
+		V& operator[] (Q&& key) {
+			return emplace(std::forward<Q>(key)).first->second;
+		}
+
+		/** Returns the number of entries erased, 0 or 1. */
+		template <typename Q>
+		size_t erase(const Q& key) {
+			const size_t slot = findSlot(key, hashKey(key));
+			if (slot == npos)
+				return 0;
+
+			const size_t index = slots[slot];
+			clearSlot(slot);
+
+			if constexpr (StableOrder) {
+				entries.erase(entries.begin() + index);
+				hashes.erase(hashes.begin() + index);
+				for (size_t i = 0; i < ctrl.size(); ++i) {
+					if (ctrl[i] >= 0 && slots[i] > index) {
+						--slots[i];
+					}
+				}
+			} else {
+				// Move the last entry into the hole and point its slot there
+				const size_t last = entries.size() - 1;
+				if (index != last) {
+					entries[index] = std::move(entries[last]);
+					hashes[index] = hashes[last];
+					slots[findIndexSlot(hashes[index], last)] = static_cast<uint32_t>(index);
+				}
+				entries.pop_back();
+				hashes.pop_back();
+			}
+
+			return 1;
+		}
+
+	private:
+		static constexpr size_t group_size = 16;
+		static constexpr size_t npos = SIZE_MAX;
+
+		// Control bytes of full slots are 7 bits of the hash, so are >= 0
+		static constexpr int8_t ctrl_empty = -128;
+		static constexpr int8_t ctrl_tombstone = -2;
+
+		std::vector<value_type> entries;
+		std::vector<uint64_t> hashes; // Of entries, so rehashing doesn't hash keys again
+
+		// Index, in groups of group_size slots
+		std::vector<int8_t> ctrl;
+		std::vector<uint32_t> slots; // Index into entries, for full slots
+		size_t group_mask;
+		size_t num_tombstones;
+
+		struct Group {
+#ifdef YKS_HAS_SSE2
+			__m128i bytes;
+
+			explicit Group(const int8_t* p)
+				: bytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))
+			{}
+
+			uint32_t match(int8_t c) const {
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(c), bytes)));
+			}
+
+			uint32_t matchFree() const {
+				// Empty and tombstone bytes are the ones with the high bit set
+				return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+			}
+#else
+			const int8_t* bytes;
+
+			explicit Group(const int8_t* p)
+				: bytes(p)
+			{}
+
+			uint32_t match(int8_t c) const {
+				uint32_t bits = 0;
+				for (size_t i = 0; i < group_size; ++i) {
+					bits |= uint32_t(bytes[i] == c) << i;
+				}
+				return bits;
+			}
+
+			uint32_t matchFree() const {
+				uint32_t bits = 0;
+				for (size_t i = 0; i < group_size; ++i) {
+					bits |= uint32_t(bytes[i] < 0) << i;
+				}
+				return bits;
+			}
+#endif
+
+			uint32_t matchEmpty() const { return match(ctrl_empty); }
+		};
+
+		static uint32_t lowestBit(uint32_t bits) {
+#if defined(_MSC_VER)
+			unsigned long i;
+			_BitScanForward(&i, bits);
+			return i;
+#else
+			return static_cast<uint32_t>(__builtin_ctz(bits));
+#endif
+		}
+
+		template <typename Q>
+		static uint64_t hashKey(const Q& key) {
+			// std::hash is often the identity for integers, so mix the bits
+			// to have good ones for both the group and the control byte.
+			const uint64_t h = uint64_t(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+			return h ^ (h >> 32);
+		}
+
+		static int8_t hashCtrl(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+		static size_t hashGroup(uint64_t hash) { return static_cast<size_t>(hash >> 7); }
+
+		/** Up to 7/8 of the slots can be used before rehashing. */
+		static size_t maxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+		static size_t capacityFor(size_t count) {
+			size_t capacity = group_size;
+			while (maxLoad(capacity) < count) {
+				capacity *= 2;
+			}
+			return capacity;
+		}
+
+		/** Returns the slot holding key, or npos. */
+		template <typename Q>
+		size_t findSlot(const Q& key, uint64_t hash) const {
+			if (ctrl.empty())
+				return npos;
+
+			const int8_t c = hashCtrl(hash);
+			size_t group = hashGroup(hash) & group_mask;
+			// Triangular probing visits every group when their number is a
+			// power of two.
+			for (size_t step = 1; ; ++step) {
+				const Group g(&ctrl[group * group_size]);
+				for (uint32_t bits = g.match(c); bits != 0; bits &= bits - 1) {
+					const size_t slot = group * group_size + lowestBit(bits);
+					if (entries[slots[slot]].first == key)
+						return slot;
+				}
+				if (g.matchEmpty() != 0)
+					return npos;
+				group = (group + step) & group_mask;
+			}
+		}
+
+		/** Returns the slot pointing to the entry at index, whose hash is hash. */
+		size_t findIndexSlot(uint64_t hash, size_t index) const {
+			const int8_t c = hashCtrl(hash);
+			size_t group = hashGroup(hash) & group_mask;
+			for (size_t step = 1; ; ++step) {
+				const Group g(&ctrl[group * group_size]);
+				for (uint32_t bits = g.match(c); bits != 0; bits &= bits - 1) {
+					const size_t slot = group * group_size + lowestBit(bits);
+					if (slots[slot] == index)
+						return slot;
+				}
+				assert(g.matchEmpty() == 0);
+				group = (group + step) & group_mask;
+			}
+		}
+
+		void insertIndex(uint64_t hash, size_t index) {
+			size_t group = hashGroup(hash) & group_mask;
+			for (size_t step = 1; ; ++step) {
+				const uint32_t bits = Group(&ctrl[group * group_size]).matchFree();
+				if (bits != 0) {
+					const size_t slot = group * group_size + lowestBit(bits);
+					if (ctrl[slot] == ctrl_tombstone) {
+						--num_tombstones;
+					}
+					ctrl[slot] = hashCtrl(hash);
+					slots[slot] = static_cast<uint32_t>(index);
+					return;
+				}
+				group = (group + step) & group_mask;
+			}
+		}
+
+		void clearSlot(size_t slot) {
+			// Probes stop at groups with an empty slot, so if this group has
+			// one no probe goes past it and the slot can be emptied too.
+			const size_t group_begin = slot - slot % group_size;
+			if (Group(&ctrl[group_begin]).matchEmpty() != 0) {
+				ctrl[slot] = ctrl_empty;
+			} else {
+				ctrl[slot] = ctrl_tombstone;
+				++num_tombstones;
+			}
+		}
+
+		/** Makes sure there's room in the index for one more entry. */
+		void prepareInsert() {
+			assert(entries.size() < UINT32_MAX); // TODO: ERROR_CHECK
+
+			const size_t capacity = ctrl.size();
+			if (entries.size() + num_tombstones + 1 <= maxLoad(capacity))
+				return;
+
+			if (capacity == 0) {
+				rehash(group_size);
+			} else if (entries.size() + 1 <= maxLoad(capacity) / 2) {
+				// Mostly tombstones, clean them up without growing
+				rehash(capacity);
+			} else {
+				rehash(capacity * 2);
+			}
+		}
+
+		void rehash(size_t capacity) {
+			ctrl.assign(capacity, ctrl_empty);
+			slots.resize(capacity);
+			group_mask = capacity / group_size - 1;
+			num_tombstones = 0;
+
+			for (size_t i = 0; i < entries.size(); ++i) {
+				insertIndex(hashes[i], i);
+			}
+		}
+	};
+
+}
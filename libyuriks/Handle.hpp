@@ -1,15 +1,23 @@
 #pragma once
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
 
 namespace yks {
 
 	struct Handle {
+		static constexpr size_t null_index = SIZE_MAX;
+		/** Type pools store roster indices as. */
+		typedef size_t index_type;
+
 		size_t index;
 		uint32_t generation;
 
 		Handle()
-			: index(SIZE_MAX), generation(~0u)
+			: index(null_index), generation(~0u)
 		{}
 
 		Handle(size_t index, uint32_t generation)
@@ -29,7 +37,95 @@ namespace yks {
 		}
 
 		bool isNull() const {
-			return index == SIZE_MAX;
+			return index == null_index;
+		}
+	};
+
+	/** Handle packed into a single unsigned integer, with IndexBits bits of
+	 * index and the rest of generation. The largest index is reserved for null
+	 * handles.
+	 *
+	 * Generations wrap around after 2^(bits - IndexBits) reuses of a slot, so
+	 * a very old handle can become valid again. Leave enough generation bits
+	 * for how long handles are kept around. */
+	template <typename Storage, unsigned int IndexBits>
+	struct PackedHandle {
+		static_assert(std::is_unsigned<Storage>::value, "Storage must be an unsigned integer");
+		static_assert(IndexBits > 0 && IndexBits < sizeof(Storage) * 8, "Need at least one bit of index and generation");
+		static_assert(IndexBits <= sizeof(size_t) * 8, "Index doesn't fit in size_t");
+
+		static constexpr unsigned int index_bits = IndexBits;
+		static constexpr unsigned int generation_bits = sizeof(Storage) * 8 - IndexBits;
+		static constexpr size_t null_index = size_t(Storage(~Storage(0)) >> generation_bits);
+		/** Type pools store roster indices as. */
+		typedef Storage index_type;
+
+		Storage index : IndexBits;
+		Storage generation : sizeof(Storage) * 8 - IndexBits;
+
+		PackedHandle()
+			: index(null_index), generation(Storage(~Storage(0)) >> index_bits)
+		{}
+
+		PackedHandle(size_t index, Storage generation)
+			: index(static_cast<Storage>(index)), generation(generation)
+		{
+			assert(index <= null_index);
+		}
+
+		/** Gets the handle as a single integer, for hashing or atomics. */
+		Storage toBits() const {
+			Storage bits;
+			std::memcpy(&bits, this, sizeof(bits));
+			return bits;
+		}
+
+		static PackedHandle fromBits(Storage bits) {
+			PackedHandle h;
+			std::memcpy(static_cast<void*>(&h), &bits, sizeof(bits));
+			return h;
+		}
+
+		bool operator ==(const PackedHandle& o) const {
+			return index == o.index && generation == o.generation;
+		}
+
+		bool operator !=(const PackedHandle& o) const {
+			return !(*this == o);
+		}
+
+		bool operator<(const PackedHandle& o) const {
+			return index < o.index;
+		}
+
+		bool isNull() const {
+			return index == null_index;
+		}
+	};
+
+	/** 16M objects, 256 generations. */
+	typedef PackedHandle<uint32_t, 24> Handle32;
+	/** 4G objects, 4G generations. */
+	typedef PackedHandle<uint64_t, 32> Handle64;
+
+	static_assert(sizeof(Handle32) == 4, "Handle32 isn't packed");
+	static_assert(sizeof(Handle64) == 8, "Handle64 isn't packed");
+
+}
+
+namespace std {
+
+	template <>
+	struct hash<yks::Handle> {
+		size_t operator()(const yks::Handle& h) const {
+			return std::hash<uint64_t>()(uint64_t(h.index) ^ uint64_t(h.generation) << 40);
+		}
+	};
+
+	template <typename Storage, unsigned int IndexBits>
+	struct hash<yks::PackedHandle<Storage, IndexBits>> {
+		size_t operator()(const yks::PackedHandle<Storage, IndexBits>& h) const {
+			return std::hash<Storage>()(h.toBits());
 		}
 	};
 
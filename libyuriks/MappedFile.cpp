@@ -0,0 +1,138 @@
+#include "MappedFile.hpp"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace yks {
+
+	// Used instead of a null pointer for empty files, which can't be mapped.
+	static const char empty_file[1] = { 0 };
+
+	MappedFile::MappedFile()
+		: ptr(nullptr), len(0), valid(false)
+#ifdef _WIN32
+		, mapping_handle(nullptr)
+#endif
+	{}
+
+#ifdef _WIN32
+	MappedFile::MappedFile(const std::string& filename)
+		: MappedFile()
+	{
+		HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size)) {
+			CloseHandle(file);
+			return;
+		}
+
+		if (file_size.QuadPart == 0) {
+			CloseHandle(file);
+			ptr = empty_file;
+			valid = true;
+			return;
+		}
+
+		mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping_handle == nullptr)
+			return;
+
+		ptr = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+		if (ptr == nullptr) {
+			CloseHandle(mapping_handle);
+			mapping_handle = nullptr;
+			return;
+		}
+
+		len = size_t(file_size.QuadPart);
+		valid = true;
+	}
+
+	void MappedFile::unmap() {
+		if (mapping_handle != nullptr) {
+			UnmapViewOfFile(ptr);
+			CloseHandle(mapping_handle);
+		}
+		ptr = nullptr;
+		len = 0;
+		valid = false;
+		mapping_handle = nullptr;
+	}
+#else
+	MappedFile::MappedFile(const std::string& filename)
+		: MappedFile()
+	{
+		const int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd == -1)
+			return;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0) {
+			close(fd);
+			return;
+		}
+
+		if (st.st_size == 0) {
+			close(fd);
+			ptr = empty_file;
+			valid = true;
+			return;
+		}
+
+		void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (p == MAP_FAILED)
+			return;
+
+		madvise(p, size_t(st.st_size), MADV_SEQUENTIAL);
+
+		ptr = static_cast<const char*>(p);
+		len = size_t(st.st_size);
+		valid = true;
+	}
+
+	void MappedFile::unmap() {
+		if (len != 0) {
+			munmap(const_cast<char*>(ptr), len);
+		}
+		ptr = nullptr;
+		len = 0;
+		valid = false;
+	}
+#endif
+
+	MappedFile::MappedFile(MappedFile&& o)
+		: MappedFile()
+	{
+		*this = std::move(o);
+	}
+
+	MappedFile::~MappedFile() {
+		unmap();
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& o) {
+		std::swap(ptr, o.ptr);
+		std::swap(len, o.len);
+		std::swap(valid, o.valid);
+#ifdef _WIN32
+		std::swap(mapping_handle, o.mapping_handle);
+#endif
+		return *this;
+	}
+
+}
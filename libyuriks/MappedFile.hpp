@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "noncopyable.hpp"
+
+namespace yks {
+
+	/** Read-only memory mapping of a whole file. */
+	struct MappedFile {
+		MappedFile();
+		explicit MappedFile(const std::string& filename);
+		MappedFile(MappedFile&& o);
+		~MappedFile();
+		MappedFile& operator=(MappedFile&& o);
+
+		bool isValid() const { return valid; }
+
+		const char* data() const { return ptr; }
+		size_t size() const { return len; }
+		std::string_view view() const { return std::string_view(ptr, len); }
+
+	private:
+		const char* ptr;
+		size_t len;
+		bool valid;
+#ifdef _WIN32
+		void* mapping_handle;
+#endif
+
+		void unmap();
+
+		NONCOPYABLE(MappedFile);
+	};
+
+}
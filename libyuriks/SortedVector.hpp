@@ -1,5 +1,9 @@
 #pragma once
+#include "Span.hpp"
+#include "prefetch.hpp"
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <tuple>
 #include <vector>
 
@@ -24,14 +28,32 @@ struct SortedVector {
 
 	Storage data;
 
+	/** Inserts val after any items with an equal key, ordering by key like
+	 * insertBulk and lookup do. */
 	iterator insert(const T& val) {
 		using std::begin;
 		using std::end;
 
-		auto insert_pos = std::lower_bound(begin(data), end(data), val);
+		auto insert_pos = std::upper_bound(begin(data), end(data), KeyPred::get(val), [](const K& k, const T& v) { return k < KeyPred::get(v); });
 		return data.insert(insert_pos, val);
 	}
 
+	/** Inserts many values at once. The batch is sorted and then merged with
+	 * the existing items, which is O(n log n) instead of the O(n^2) of
+	 * inserting one at a time. Items with equal keys keep their order. */
+	void insertBulk(yks::Span<const T> values) {
+		using std::begin;
+		using std::end;
+
+		const size_t old_size = data.size();
+		data.insert(end(data), values.begin(), values.end());
+
+		auto key_less = [](const T& a, const T& b) { return KeyPred::get(a) < KeyPred::get(b); };
+		auto middle = begin(data) + old_size;
+		std::stable_sort(middle, end(data), key_less);
+		std::inplace_merge(begin(data), middle, end(data), key_less);
+	}
+
 	iterator lookup(const K& key) {
 		using std::begin;
 		using std::end;
@@ -55,3 +77,113 @@ struct SortedVector {
 		return false;
 	}
 };
+
+/** Read-only copy of a SortedVector laid out for fast lookups. Keys are
+ * stored in Eytzinger (breadth-first) order, so the first levels of every
+ * search share the same few cache lines and the children of a node are next
+ * to each other, which lets the search prefetch several levels ahead. Keys
+ * are kept apart from values so that searching doesn't load values. */
+template <typename T, typename KeyPred = TupleKey<T>>
+struct FrozenSortedVector {
+	typedef typename KeyPred::Key K;
+
+	explicit FrozenSortedVector(const SortedVector<T, KeyPred>& sorted)
+		: keys(sorted.data.size() + 1), values(sorted.data)
+	{
+		// Node 0 is unused so that the children of node k are 2k and 2k+1
+		const size_t consumed = build(sorted.data, 0, 1);
+		assert(consumed == sorted.data.size());
+		(void) consumed;
+	}
+
+	/** Returns the first item with key, or nullptr if there's none. */
+	const T* lookup(const K& key) const {
+		const size_t n = size();
+		size_t k = 1;
+		while (k <= n) {
+			prefetchLevels(k);
+			k = 2 * k + (keys[k] < key);
+		}
+		return found(resolve(k), key);
+	}
+
+	/** Looks up many keys at once, writing the results (nullptr if not found)
+	 * to out_values. Searches are interleaved so their cache misses overlap. */
+	void lookupBatch(yks::Span<const K> query_keys, const T** out_values) const {
+		static const size_t GROUP = 8;
+
+		const size_t n = size();
+		// Levels every search goes through, the last one may be partial
+		size_t full_levels = 0;
+		while ((size_t(2) << full_levels) - 1 <= n) {
+			++full_levels;
+		}
+
+		for (size_t begin = 0; begin < query_keys.size(); begin += GROUP) {
+			const size_t count = std::min(GROUP, query_keys.size() - begin);
+			const K* q = query_keys.data() + begin;
+
+			size_t k[GROUP];
+			for (size_t j = 0; j < count; ++j) {
+				k[j] = 1;
+			}
+			for (size_t level = 0; level < full_levels; ++level) {
+				for (size_t j = 0; j < count; ++j) {
+					prefetchLevels(k[j]);
+					k[j] = 2 * k[j] + (keys[k[j]] < q[j]);
+				}
+			}
+			for (size_t j = 0; j < count; ++j) {
+				if (k[j] <= n) {
+					k[j] = 2 * k[j] + (keys[k[j]] < q[j]);
+				}
+				out_values[begin + j] = found(resolve(k[j]), q[j]);
+			}
+		}
+	}
+
+	size_t size() const { return values.size(); }
+
+	/** Items in layout order, not sorted. */
+	yks::Span<const T> items() const { return values; }
+
+private:
+	static constexpr size_t keys_per_line = 64 / sizeof(K) > 0 ? 64 / sizeof(K) : 1;
+
+	std::vector<K> keys; // In Eytzinger order, starting at 1
+	std::vector<T> values; // values[k - 1] belongs to keys[k]
+
+	/** Fills the subtree rooted at k with sorted items starting at i. Returns
+	 * the index of the first item not used. */
+	size_t build(const std::vector<T>& sorted, size_t i, size_t k) {
+		if (k < keys.size()) {
+			i = build(sorted, i, 2 * k);
+			keys[k] = KeyPred::get(sorted[i]);
+			values[k - 1] = sorted[i++];
+			i = build(sorted, i, 2 * k + 1);
+		}
+		return i;
+	}
+
+	/** Prefetches the descendants of k a cache line's worth of levels down. */
+	void prefetchLevels(size_t k) const {
+		const size_t ahead = k * keys_per_line;
+		yks::prefetch(&keys[ahead < keys.size() ? ahead : 0]);
+	}
+
+	/** Turns the node where a search fell off the tree into the node of the
+	 * lower bound, or 0 if all keys are smaller. The search went right at
+	 * every trailing 1 bit, so those are undone along with the last left turn. */
+	static size_t resolve(size_t k) {
+		while (k & 1) {
+			k >>= 1;
+		}
+		return k >> 1;
+	}
+
+	const T* found(size_t k, const K& key) const {
+		if (k != 0 && !(key < keys[k]))
+			return &values[k - 1];
+		return nullptr;
+	}
+};
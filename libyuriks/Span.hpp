@@ -0,0 +1,58 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace yks {
+
+	/** Non-owning view of a contiguous array of T. */
+	template <typename T>
+	struct Span {
+		typedef T* iterator;
+
+		Span()
+			: ptr(nullptr), len(0)
+		{}
+
+		Span(T* data, size_t size)
+			: ptr(data), len(size)
+		{}
+
+		template <typename U>
+		Span(const Span<U>& o)
+			: ptr(o.data()), len(o.size())
+		{}
+
+		template <typename U, typename A>
+		Span(std::vector<U, A>& v)
+			: ptr(v.data()), len(v.size())
+		{}
+
+		template <typename U, typename A>
+		Span(const std::vector<U, A>& v)
+			: ptr(v.data()), len(v.size())
+		{}
+
+		T* data() const { return ptr; }
+		size_t size() const { return len; }
+		bool empty() const { return len == 0; }
+
+		T* begin() const { return ptr; }
+		T* end() const { return ptr + len; }
+
+		T& operator[] (size_t i) const {
+			assert(i < len);
+			return ptr[i];
+		}
+
+		Span subspan(size_t offset, size_t count) const {
+			assert(offset + count <= len);
+			return Span(ptr + offset, count);
+		}
+
+	private:
+		T* ptr;
+		size_t len;
+	};
+
+}
@@ -1,5 +1,6 @@
 #include "csv.hpp"
 #include <cassert>
+#include <charconv>
 
 namespace yks {
 
@@ -18,4 +19,79 @@ namespace yks {
 		return str.substr(start_pos, field_len);
 	}
 
-}
\ No newline at end of file
+	CsvReader::CsvReader(std::string_view data)
+		: data(data), pos(0), field_pos(1)
+	{}
+
+	bool CsvReader::nextRow() {
+		while (pos < data.size()) {
+			std::string_view::size_type line_end = data.find('\n', pos);
+			if (line_end == std::string_view::npos) {
+				line_end = data.size();
+			}
+
+			row = data.substr(pos, line_end - pos);
+			pos = line_end + 1;
+
+			if (!row.empty() && row.back() == '\r') {
+				row.remove_suffix(1);
+			}
+			if (!row.empty()) {
+				field_pos = 0;
+				return true;
+			}
+		}
+
+		row = std::string_view();
+		field_pos = 1;
+		return false;
+	}
+
+	std::string_view CsvReader::nextField() {
+		if (!hasMoreFields())
+			return std::string_view();
+
+		const std::string_view::size_type start_pos = field_pos;
+		std::string_view::size_type end_pos = row.find(',', field_pos);
+		if (end_pos == std::string_view::npos) {
+			end_pos = row.size();
+		}
+
+		field_pos = end_pos + 1; // Skip past ','
+		return row.substr(start_pos, end_pos - start_pos);
+	}
+
+	bool parseCsvInt(std::string_view field, int& value) {
+		while (!field.empty() && field.front() == ' ') field.remove_prefix(1);
+		while (!field.empty() && field.back() == ' ') field.remove_suffix(1);
+
+		const char* end = field.data() + field.size();
+		auto result = std::from_chars(field.data(), end, value);
+		return result.ec == std::errc() && result.ptr == end;
+	}
+
+	std::vector<std::string_view> splitCsvChunks(std::string_view data, size_t max_chunks) {
+		std::vector<std::string_view> chunks;
+		if (max_chunks == 0)
+			max_chunks = 1;
+
+		const size_t target_size = data.size() / max_chunks + 1;
+
+		std::string_view::size_type pos = 0;
+		while (pos < data.size()) {
+			std::string_view::size_type chunk_end = pos + target_size;
+			if (chunk_end >= data.size()) {
+				chunk_end = data.size();
+			} else {
+				chunk_end = data.find('\n', chunk_end);
+				chunk_end = chunk_end == std::string_view::npos ? data.size() : chunk_end + 1;
+			}
+
+			chunks.push_back(data.substr(pos, chunk_end - pos));
+			pos = chunk_end;
+		}
+
+		return chunks;
+	}
+
+}
@@ -1,6 +1,34 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace yks {
 	std::string getNextCsvField(const std::string& str, std::string::size_type& cur_pos);
+
+	/** Iterates over the rows and fields of CSV data in memory, without
+	 * copying. Like getNextCsvField, doesn't support quoted fields. */
+	struct CsvReader {
+		explicit CsvReader(std::string_view data);
+
+		/** Moves to the next non-empty row. Returns false at end of data. */
+		bool nextRow();
+		/** Returns the next field in the current row. */
+		std::string_view nextField();
+		bool hasMoreFields() const { return field_pos <= row.size(); }
+
+	private:
+		std::string_view data;
+		std::string_view::size_type pos;
+
+		std::string_view row;
+		std::string_view::size_type field_pos;
+	};
+
+	/** Parses a whole field as a decimal integer, ignoring surrounding spaces. */
+	bool parseCsvInt(std::string_view field, int& value);
+
+	/** Splits data into at most max_chunks pieces of similar size, each
+	 * ending at a line break, so they can be parsed independently. */
+	std::vector<std::string_view> splitCsvChunks(std::string_view data, size_t max_chunks);
 }
@@ -2,6 +2,7 @@
 #include <cmath>
 #include <cassert>
 #include "vec.hpp"
+#include "fastmath.hpp"
 
 namespace yks {
 
@@ -13,7 +14,9 @@ namespace yks {
 		Complex(vec2 v) : r(v[0]), i(v[1]) {}
 
 		static Complex from_angle(float radians) {
-			return Complex(std::cos(radians), std::sin(radians));
+			float s, c;
+			fast_sincos(radians, s, c);
+			return Complex(c, s);
 		}
 
 		inline vec2 as_vec() const {
@@ -1,6 +1,7 @@
 #include "MatrixTransform.hpp"
 
 #include "misc.hpp"
+#include "simd.hpp"
 #include <cmath>
 
 namespace yks {
@@ -81,4 +82,66 @@ namespace yks {
 		return pad<4>(orient(up, normalized(target - camera))) * translate(-camera);
 	}
 
+	namespace {
+		/** w is the fourth coordinate of the points, 1 or 0. Sums are done in
+		 * the same order as mat4 * vec4 so results match it exactly. */
+		void transform_soa(const mat4& m, float w, const float* x, const float* y, const float* z,
+			float* out_x, float* out_y, float* out_z, size_t count)
+		{
+			size_t i = 0;
+
+#ifdef YKS_HAS_SSE2
+			__m128 mm[3][4];
+			for (unsigned int r = 0; r < 3; ++r) {
+				for (unsigned int c = 0; c < 4; ++c) {
+					mm[r][c] = _mm_set1_ps(c == 3 ? m(r,c) * w : m(r,c));
+				}
+			}
+
+			for (; i + 4 <= count; i += 4) {
+				const __m128 px = _mm_loadu_ps(x + i);
+				const __m128 py = _mm_loadu_ps(y + i);
+				const __m128 pz = _mm_loadu_ps(z + i);
+
+				__m128 res[3];
+				for (unsigned int r = 0; r < 3; ++r) {
+					__m128 s = noReassociate(_mm_mul_ps(mm[r][0], px));
+					s = noReassociate(_mm_add_ps(s, _mm_mul_ps(mm[r][1], py)));
+					s = noReassociate(_mm_add_ps(s, _mm_mul_ps(mm[r][2], pz)));
+					res[r] = _mm_add_ps(s, mm[r][3]);
+				}
+				_mm_storeu_ps(out_x + i, res[0]);
+				_mm_storeu_ps(out_y + i, res[1]);
+				_mm_storeu_ps(out_z + i, res[2]);
+			}
+#endif
+
+			for (; i < count; ++i) {
+				const float px = x[i], py = y[i], pz = z[i];
+				float res[3];
+				for (unsigned int r = 0; r < 3; ++r) {
+					float s = noReassociate(m(r,0) * px);
+					s = noReassociate(s + m(r,1) * py);
+					s = noReassociate(s + m(r,2) * pz);
+					res[r] = s + m(r,3) * w;
+				}
+				out_x[i] = res[0];
+				out_y[i] = res[1];
+				out_z[i] = res[2];
+			}
+		}
+	}
+
+	void transform_points(const mat4& m, const float* x, const float* y, const float* z,
+		float* out_x, float* out_y, float* out_z, size_t count)
+	{
+		transform_soa(m, 1.0f, x, y, z, out_x, out_y, out_z, count);
+	}
+
+	void transform_directions(const mat4& m, const float* x, const float* y, const float* z,
+		float* out_x, float* out_y, float* out_z, size_t count)
+	{
+		transform_soa(m, 0.0f, x, y, z, out_x, out_y, out_z, count);
+	}
+
 }
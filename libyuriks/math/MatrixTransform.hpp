@@ -2,6 +2,7 @@
 
 #include "mat.hpp"
 #include "vec.hpp"
+#include <cstddef>
 
 namespace yks {
 
@@ -50,4 +51,13 @@ namespace yks {
 	// Cameras
 	mat4 look_at(const vec3& up, const vec3& camera, const vec3& target);
 
+	// Batch transforms of points stored as separate x, y and z arrays. Output
+	// arrays may be the same as the input ones. Results are the same as
+	// mvec3(m * mvec4(p, 1)) for points and mvec3(m * mvec4(p, 0)) for
+	// directions, the bottom row of m is ignored.
+	void transform_points(const mat4& m, const float* x, const float* y, const float* z,
+		float* out_x, float* out_y, float* out_z, size_t count);
+	void transform_directions(const mat4& m, const float* x, const float* y, const float* z,
+		float* out_x, float* out_y, float* out_z, size_t count);
+
 }
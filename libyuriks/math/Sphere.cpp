@@ -2,6 +2,7 @@
 #include "./misc.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 namespace yks {
 
@@ -19,6 +20,91 @@ namespace yks {
 		}
 	}
 
+#ifdef YKS_HAS_SSE2
+	namespace sphere_detail {
+		// Does the same operations as intersect_with_sphere
+		int intersect_with_spheres4(const float* center_x, const float* center_y, const float* center_z,
+			const float* radius, const Ray& r, float a, float* t)
+		{
+			const __m128 ox = _mm_sub_ps(_mm_set1_ps(r.origin[0]), _mm_loadu_ps(center_x));
+			const __m128 oy = _mm_sub_ps(_mm_set1_ps(r.origin[1]), _mm_loadu_ps(center_y));
+			const __m128 oz = _mm_sub_ps(_mm_set1_ps(r.origin[2]), _mm_loadu_ps(center_z));
+			const __m128 vx = _mm_set1_ps(r.direction[0]);
+			const __m128 vy = _mm_set1_ps(r.direction[1]);
+			const __m128 vz = _mm_set1_ps(r.direction[2]);
+			const __m128 rad = _mm_loadu_ps(radius);
+
+			const __m128 o_dot_v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ox, vx), _mm_mul_ps(oy, vy)), _mm_mul_ps(oz, vz));
+			const __m128 o_dot_o = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ox, ox), _mm_mul_ps(oy, oy)), _mm_mul_ps(oz, oz));
+			const __m128 b = _mm_mul_ps(_mm_set1_ps(2.0f), o_dot_v);
+			const __m128 c = _mm_sub_ps(o_dot_o, _mm_mul_ps(rad, rad));
+			const __m128 delta = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(_mm_set1_ps(4 * a), c));
+
+			// Lanes with delta < 0 get NaN here, but they're masked out
+			const __m128 neg_b = _mm_xor_ps(b, _mm_set1_ps(-0.0f));
+			const __m128 t1 = _mm_div_ps(_mm_sub_ps(neg_b, _mm_sqrt_ps(delta)), _mm_set1_ps(2 * a));
+			_mm_storeu_ps(t, t1);
+
+			const __m128 zero = _mm_setzero_ps();
+			return _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(delta, zero), _mm_cmpge_ps(t1, zero)));
+		}
+	}
+#endif
+
+	size_t intersect_with_spheres(const float* center_x, const float* center_y, const float* center_z,
+		const float* radius, size_t count, const Ray& r, float& t)
+	{
+		size_t best = SIZE_MAX;
+		float best_t = 0.0f;
+		size_t i = 0;
+
+#ifdef YKS_HAS_SSE2
+		const float a = dot(r.direction, r.direction);
+		float lane_t[4];
+		for (; i + 4 <= count; i += 4) {
+			int mask = sphere_detail::intersect_with_spheres4(center_x + i, center_y + i, center_z + i, radius + i, r, a, lane_t);
+			for (unsigned int lane = 0; mask != 0; ++lane, mask >>= 1) {
+				if ((mask & 1) && (best == SIZE_MAX || lane_t[lane] < best_t)) {
+					best = i + lane;
+					best_t = lane_t[lane];
+				}
+			}
+		}
+
+		// Pad the rest to a full group, masking out the padding
+		if (i < count) {
+			float x[4] = {}, y[4] = {}, z[4] = {}, rad[4] = {};
+			const size_t rest = count - i;
+			for (size_t j = 0; j < rest; ++j) {
+				x[j] = center_x[i + j];
+				y[j] = center_y[i + j];
+				z[j] = center_z[i + j];
+				rad[j] = radius[i + j];
+			}
+			int mask = sphere_detail::intersect_with_spheres4(x, y, z, rad, r, a, lane_t) & ((1 << rest) - 1);
+			for (unsigned int lane = 0; mask != 0; ++lane, mask >>= 1) {
+				if ((mask & 1) && (best == SIZE_MAX || lane_t[lane] < best_t)) {
+					best = i + lane;
+					best_t = lane_t[lane];
+				}
+			}
+		}
+#else
+		for (; i < count; ++i) {
+			const Optional<float> hit = intersect_with_sphere(mvec3(center_x[i], center_y[i], center_z[i]), radius[i], r);
+			if (hit && (best == SIZE_MAX || *hit < best_t)) {
+				best = i;
+				best_t = *hit;
+			}
+		}
+#endif
+
+		if (best != SIZE_MAX) {
+			t = best_t;
+		}
+		return best;
+	}
+
 	vec3 uniform_point_on_sphere(float a, float b) {
 		const float y = 2.0f * a - 1.0f;
 		const float longitude = b * two_pi;
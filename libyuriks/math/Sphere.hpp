@@ -2,11 +2,33 @@
 #include "./vec.hpp"
 #include "./Ray.hpp"
 #include "Optional.hpp"
+#include <cstddef>
+#include "simd.hpp"
 
 namespace yks {
 	Optional<float> intersect_with_sphere(const vec3& origin, float radius, const Ray& r);
 
+	/// Tests r against count spheres, given as one array per coordinate, 4 at
+	/// a time with SSE2. Returns the index of the sphere intersect_with_sphere
+	/// gives the smallest result for, setting t to it, or SIZE_MAX if it
+	/// gives none for all of them. With -ffast-math, t can differ from what
+	/// intersect_with_sphere gives in the last bits, or by up to about 5e-4
+	/// relative for rays grazing the sphere.
+	size_t intersect_with_spheres(const float* center_x, const float* center_y, const float* center_z,
+		const float* radius, size_t count, const Ray& r, float& t);
+
+#ifdef YKS_HAS_SSE2
+	namespace sphere_detail {
+		/// Does what intersect_with_spheres does for 4 spheres, a being the
+		/// squared length of the ray direction. Returns a mask of the spheres
+		/// hit, storing the distances of all 4 in t.
+		int intersect_with_spheres4(const float* center_x, const float* center_y, const float* center_z,
+			const float* radius, const Ray& r, float a, float* t);
+	}
+#endif
+
 	/// Generates an uniformly distributed point on the surface of the unit
 	/// sphere centered on 0.  a and b are two numbers in [0,1).
+	/// SphereSampling.hpp has faster versions for many points at once.
 	vec3 uniform_point_on_sphere(float a, float b);
 }
@@ -0,0 +1,350 @@
+#include "./SphereBvh.hpp"
+#include "./Sphere.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cfloat>
+#include <thread>
+
+namespace yks {
+
+	namespace {
+		static const unsigned int NUM_BINS = 16;
+		static const size_t MAX_LEAF_SIZE = 4;
+		// Deeper nodes are made leaves, which bounds the traversal stack
+		static const unsigned int MAX_DEPTH = 64;
+
+		struct Aabb {
+			vec3 min = mvec3(FLT_MAX, FLT_MAX, FLT_MAX);
+			vec3 max = mvec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+			void grow(const vec3& p) {
+				for (unsigned int i = 0; i < 3; ++i) {
+					min[i] = std::min(min[i], p[i]);
+					max[i] = std::max(max[i], p[i]);
+				}
+			}
+
+			void grow(const Aabb& b) {
+				for (unsigned int i = 0; i < 3; ++i) {
+					min[i] = std::min(min[i], b.min[i]);
+					max[i] = std::max(max[i], b.max[i]);
+				}
+			}
+
+			/** Half of the surface area, which is enough to compare costs. */
+			float half_area() const {
+				const vec3 d = max - min;
+				return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+			}
+		};
+
+		struct BuildSphere {
+			Aabb bounds;
+			vec3 center;
+			uint32_t index;
+		};
+
+		struct Bin {
+			Aabb bounds;
+			size_t count = 0;
+		};
+
+		/** Entry distance of the ray into the box, or FLT_MAX if it misses it
+		 * or enters it further than max_t. */
+		float intersect_bounds(const float* bounds_min, const float* bounds_max,
+			const vec3& origin, const vec3& inv_dir, float max_t)
+		{
+			float t_enter = 0.0f;
+			float t_exit = max_t;
+			for (unsigned int i = 0; i < 3; ++i) {
+				const float t0 = (bounds_min[i] - origin[i]) * inv_dir[i];
+				const float t1 = (bounds_max[i] - origin[i]) * inv_dir[i];
+				t_enter = std::max(t_enter, std::min(t0, t1));
+				t_exit = std::min(t_exit, std::max(t0, t1));
+			}
+			return t_enter <= t_exit ? t_enter : FLT_MAX;
+		}
+	}
+
+	struct SphereBvhBuilder {
+		SphereBvh& bvh;
+		std::vector<BuildSphere>& spheres;
+
+		uint32_t build_node(size_t begin, size_t end, unsigned int depth) {
+			const uint32_t node_i = static_cast<uint32_t>(bvh.nodes.size());
+			bvh.nodes.emplace_back();
+
+			Aabb bounds, centroid_bounds;
+			for (size_t i = begin; i < end; ++i) {
+				bounds.grow(spheres[i].bounds);
+				centroid_bounds.grow(spheres[i].center);
+			}
+			for (unsigned int i = 0; i < 3; ++i) {
+				bvh.nodes[node_i].bounds_min[i] = bounds.min[i];
+				bvh.nodes[node_i].bounds_max[i] = bounds.max[i];
+			}
+
+			const size_t count = end - begin;
+			unsigned int split_axis = 0;
+			unsigned int split_bin = 0;
+			if (count > MAX_LEAF_SIZE && depth + 1 < MAX_DEPTH) {
+				find_split(begin, end, centroid_bounds, split_axis, split_bin);
+			}
+
+			// No split found means all centers are the same, so there's no
+			// good way to split them
+			if (split_bin == 0) {
+				bvh.nodes[node_i].first = static_cast<uint32_t>(begin);
+				bvh.nodes[node_i].count = static_cast<uint32_t>(count);
+				return node_i;
+			}
+
+			const float axis_min = centroid_bounds.min[split_axis];
+			const float scale = NUM_BINS / (centroid_bounds.max[split_axis] - axis_min);
+			const BuildSphere* mid = std::partition(&spheres[begin], &spheres[0] + end, [&](const BuildSphere& s) {
+				return bin_of(s.center[split_axis], axis_min, scale) < split_bin;
+			});
+			const size_t mid_i = mid - &spheres[0];
+
+			build_node(begin, mid_i, depth + 1);
+			const uint32_t right = build_node(mid_i, end, depth + 1);
+			bvh.nodes[node_i].first = right;
+			bvh.nodes[node_i].count = 0;
+			return node_i;
+		}
+
+		static unsigned int bin_of(float c, float axis_min, float scale) {
+			const unsigned int bin = static_cast<unsigned int>((c - axis_min) * scale);
+			return std::min(bin, NUM_BINS - 1);
+		}
+
+		/** Finds the split with the lowest cost, splitting before split_bin.
+		 * Leaves split_bin 0 if there's none. */
+		void find_split(size_t begin, size_t end, const Aabb& centroid_bounds,
+			unsigned int& split_axis, unsigned int& split_bin)
+		{
+			float best_cost = FLT_MAX;
+			for (unsigned int axis = 0; axis < 3; ++axis) {
+				const float axis_min = centroid_bounds.min[axis];
+				const float extent = centroid_bounds.max[axis] - axis_min;
+				if (!(extent > 0.0f))
+					continue;
+
+				const float scale = NUM_BINS / extent;
+				Bin bins[NUM_BINS];
+				for (size_t i = begin; i < end; ++i) {
+					Bin& bin = bins[bin_of(spheres[i].center[axis], axis_min, scale)];
+					bin.bounds.grow(spheres[i].bounds);
+					bin.count += 1;
+				}
+
+				// Costs of everything right of each split, then sweep from the left
+				float right_cost[NUM_BINS];
+				Aabb right_bounds;
+				size_t right_count = 0;
+				for (unsigned int b = NUM_BINS - 1; b > 0; --b) {
+					right_bounds.grow(bins[b].bounds);
+					right_count += bins[b].count;
+					right_cost[b] = right_count == 0 ? 0.0f : right_bounds.half_area() * right_count;
+				}
+
+				Aabb left_bounds;
+				size_t left_count = 0;
+				for (unsigned int b = 1; b < NUM_BINS; ++b) {
+					left_bounds.grow(bins[b - 1].bounds);
+					left_count += bins[b - 1].count;
+					if (left_count == 0 || left_count == end - begin)
+						continue;
+
+					const float cost = left_bounds.half_area() * left_count + right_cost[b];
+					if (cost < best_cost) {
+						best_cost = cost;
+						split_axis = axis;
+						split_bin = b;
+					}
+				}
+			}
+		}
+	};
+
+	void SphereBvh::build(Span<const vec3> centers, Span<const float> radii) {
+		assert(centers.size() == radii.size());
+		assert(centers.size() < SphereHit::NONE); // TODO: ERROR_CHECK
+
+		nodes.clear();
+		center_x.clear();
+		center_y.clear();
+		center_z.clear();
+		radius.clear();
+		sphere_index.clear();
+		if (centers.empty())
+			return;
+
+		std::vector<BuildSphere> spheres(centers.size());
+		for (size_t i = 0; i < centers.size(); ++i) {
+			const vec3 extent = mvec3(radii[i], radii[i], radii[i]);
+			spheres[i].bounds.grow(centers[i] - extent);
+			spheres[i].bounds.grow(centers[i] + extent);
+			spheres[i].center = centers[i];
+			spheres[i].index = static_cast<uint32_t>(i);
+		}
+
+		nodes.reserve(2 * (spheres.size() / MAX_LEAF_SIZE) + 1);
+		SphereBvhBuilder builder = { *this, spheres };
+		builder.build_node(0, spheres.size(), 0);
+
+		center_x.reserve(spheres.size() + 3);
+		center_y.reserve(spheres.size() + 3);
+		center_z.reserve(spheres.size() + 3);
+		radius.reserve(spheres.size() + 3);
+		sphere_index.reserve(spheres.size());
+		for (const BuildSphere& s : spheres) {
+			center_x.push_back(s.center[0]);
+			center_y.push_back(s.center[1]);
+			center_z.push_back(s.center[2]);
+			radius.push_back(radii[s.index]);
+			sphere_index.push_back(s.index);
+		}
+		// Padding so that leaves can always be tested 4 spheres at a time
+		for (unsigned int i = 0; i < 3; ++i) {
+			center_x.push_back(0.0f);
+			center_y.push_back(0.0f);
+			center_z.push_back(0.0f);
+			radius.push_back(0.0f);
+		}
+	}
+
+	SphereHit SphereBvh::trace(const Ray& r) const {
+		SphereHit hit = { SphereHit::NONE, FLT_MAX };
+		if (nodes.empty())
+			return hit;
+
+		const vec3 inv_dir = mvec3(1.0f / r.direction[0], 1.0f / r.direction[1], 1.0f / r.direction[2]);
+#ifdef YKS_HAS_SSE2
+		const float a = dot(r.direction, r.direction);
+#endif
+
+		// Nodes left to visit, with the distance the ray enters them at
+		struct StackEntry {
+			uint32_t node;
+			float t;
+		};
+		StackEntry stack[MAX_DEPTH];
+		unsigned int stack_size = 0;
+
+		uint32_t node_i = 0;
+		if (intersect_bounds(nodes[0].bounds_min, nodes[0].bounds_max, r.origin, inv_dir, hit.t) == FLT_MAX)
+			return hit;
+
+		for (;;) {
+			const Node& node = nodes[node_i];
+			if (node.count != 0) {
+#ifdef YKS_HAS_SSE2
+				for (uint32_t j = 0; j < node.count; j += 4) {
+					const size_t first = node.first + j;
+					float lane_t[4];
+					int mask = sphere_detail::intersect_with_spheres4(center_x.data() + first, center_y.data() + first,
+						center_z.data() + first, radius.data() + first, r, a, lane_t);
+					if (node.count - j < 4) {
+						mask &= (1 << (node.count - j)) - 1;
+					}
+					for (unsigned int lane = 0; mask != 0; ++lane, mask >>= 1) {
+						if ((mask & 1) && (lane_t[lane] < hit.t || hit.sphere == SphereHit::NONE)) {
+							hit.sphere = sphere_index[first + lane];
+							hit.t = lane_t[lane];
+						}
+					}
+				}
+#else
+				float t;
+				const size_t i = intersect_with_spheres(&center_x[node.first], &center_y[node.first], &center_z[node.first],
+					&radius[node.first], node.count, r, t);
+				if (i != SIZE_MAX && (t < hit.t || hit.sphere == SphereHit::NONE)) {
+					hit.sphere = sphere_index[node.first + i];
+					hit.t = t;
+				}
+#endif
+			} else {
+				// Visit the nearest child first, so that the other one can
+				// be skipped if something closer than it was hit
+				uint32_t near_i = node_i + 1;
+				uint32_t far_i = node.first;
+				float near_t = intersect_bounds(nodes[near_i].bounds_min, nodes[near_i].bounds_max, r.origin, inv_dir, hit.t);
+				float far_t = intersect_bounds(nodes[far_i].bounds_min, nodes[far_i].bounds_max, r.origin, inv_dir, hit.t);
+				if (far_t < near_t) {
+					std::swap(near_i, far_i);
+					std::swap(near_t, far_t);
+				}
+
+				if (near_t != FLT_MAX) {
+					if (far_t != FLT_MAX) {
+						stack[stack_size++] = StackEntry{ far_i, far_t };
+					}
+					node_i = near_i;
+					continue;
+				}
+			}
+
+			// Pop until a node that the ray enters before the closest hit
+			for (;;) {
+				if (stack_size == 0)
+					return hit;
+				const StackEntry& entry = stack[--stack_size];
+				if (entry.t <= hit.t) {
+					node_i = entry.node;
+					break;
+				}
+			}
+		}
+	}
+
+	Optional<SphereHit> SphereBvh::intersect(const Ray& r) const {
+		const SphereHit hit = trace(r);
+		if (hit.sphere == SphereHit::NONE) {
+			return Optional<SphereHit>();
+		} else {
+			return make_optional<SphereHit>(hit);
+		}
+	}
+
+	void SphereBvh::intersect(Span<const Ray> rays, Span<SphereHit> hits, unsigned int num_threads) const {
+		assert(rays.size() == hits.size());
+
+		// Threads are started for each call, which only pays off for
+		// batches with enough work
+		static const size_t PARALLEL_MIN_RAYS = 1024;
+		if (num_threads == 0) {
+			num_threads = 1;
+			if (rays.size() >= PARALLEL_MIN_RAYS) {
+				num_threads = std::max(1u, std::thread::hardware_concurrency());
+			}
+		}
+
+		// Rays are handed out in blocks as threads ask for them, since some
+		// take much longer than others
+		static const size_t BLOCK_SIZE = 64;
+		std::atomic<size_t> next_block(0);
+		auto worker = [&]() {
+			for (;;) {
+				const size_t begin = next_block.fetch_add(BLOCK_SIZE);
+				if (begin >= rays.size())
+					return;
+				const size_t end = std::min(begin + BLOCK_SIZE, rays.size());
+				for (size_t i = begin; i < end; ++i) {
+					hits[i] = trace(rays[i]);
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (unsigned int i = 1; i < num_threads; ++i) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (std::thread& t : threads) {
+			t.join();
+		}
+	}
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "./vec.hpp"
+#include "./Ray.hpp"
+#include "Optional.hpp"
+#include "Span.hpp"
+
+namespace yks {
+
+	struct SphereHit {
+		static const uint32_t NONE = UINT32_MAX;
+
+		/// Index of the sphere, as given to SphereBvh::build, or NONE.
+		uint32_t sphere;
+		float t;
+	};
+
+	/// Bounding volume hierarchy over a set of spheres, to find the nearest one
+	/// hit by rays. Hits are on the same spheres intersect_with_sphere gives,
+	/// with t equal up to rounding (see intersect_with_spheres).
+	struct SphereBvh {
+		/// Builds the tree, splitting nodes where the surface area heuristic
+		/// is lowest, estimated with a few bins per axis.
+		void build(Span<const vec3> centers, Span<const float> radii);
+
+		Optional<SphereHit> intersect(const Ray& r) const;
+		/// Intersects all rays, writing the results to hits. Big batches are
+		/// split between num_threads threads, or one per core if it's 0.
+		void intersect(Span<const Ray> rays, Span<SphereHit> hits, unsigned int num_threads = 0) const;
+
+		size_t node_count() const { return nodes.size(); }
+
+	private:
+		struct Node {
+			float bounds_min[3];
+			float bounds_max[3];
+			// For leaves, the first sphere. Otherwise the second child, the
+			// first one being right after this node.
+			uint32_t first;
+			// 0 for inner nodes
+			uint32_t count;
+		};
+
+		std::vector<Node> nodes;
+		// Spheres in leaf order, one array per coordinate
+		std::vector<float> center_x;
+		std::vector<float> center_y;
+		std::vector<float> center_z;
+		std::vector<float> radius;
+		std::vector<uint32_t> sphere_index;
+
+		SphereHit trace(const Ray& r) const;
+
+		friend struct SphereBvhBuilder;
+	};
+
+}
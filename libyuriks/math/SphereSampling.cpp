@@ -0,0 +1,266 @@
+#include "./SphereSampling.hpp"
+#include "./fastmath.hpp"
+#include "./misc.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace yks {
+
+	namespace {
+		// R2 sequence steps, 1/g and 1/g^2 for the plastic number g, in
+		// 32 bit fixed point. Points are offset by 0.5 as in the original.
+		static const uint32_t R2_STEP_U = 0xC13FA9A9u;
+		static const uint32_t R2_STEP_V = 0x91E10DA5u;
+		static const uint32_t R2_OFFSET = 0x80000000u;
+
+		static const float UNIT_FROM_BITS = 1.0f / 16777216.0f;
+
+		uint64_t splitmix64(uint64_t& x) {
+			uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+		// The sphere is y = a*y_scale + y_offset, at an angle of b*two_pi
+		// around the y axis, like uniform_point_on_sphere.
+		struct SphereMapping {
+			float y_scale;
+			float y_offset;
+		};
+		static const SphereMapping SPHERE = { 2.0f, -1.0f };
+		static const SphereMapping HEMISPHERE = { 1.0f, 0.0f };
+
+		// Same lanes as the SSE2 version, so that both give the same points.
+		// Used without SSE2, and by the sampling_detail functions.
+		struct ScalarRandomSource {
+			SampleRng& rng;
+
+			explicit ScalarRandomSource(SampleRng& rng) : rng(rng) {}
+
+			void save(SampleRng&) const {}
+
+			void next_bits(uint32_t* result) {
+				uint32_t (&s)[4][4] = rng.state;
+				for (unsigned int lane = 0; lane < 4; ++lane) {
+					result[lane] = s[0][lane] + s[3][lane];
+					const uint32_t t = s[1][lane] << 9;
+					s[2][lane] ^= s[0][lane];
+					s[3][lane] ^= s[1][lane];
+					s[1][lane] ^= s[2][lane];
+					s[0][lane] ^= s[3][lane];
+					s[2][lane] ^= t;
+					s[3][lane] = (s[3][lane] << 11) | (s[3][lane] >> 21);
+				}
+			}
+
+			void next(uint32_t* a, uint32_t* b) {
+				next_bits(a);
+				next_bits(b);
+			}
+		};
+
+		struct ScalarR2Source {
+			uint32_t u, v;
+
+			explicit ScalarR2Source(size_t first) {
+				const uint32_t n = uint32_t(first);
+				u = R2_OFFSET + n * R2_STEP_U;
+				v = R2_OFFSET + n * R2_STEP_V;
+			}
+
+			void next(uint32_t* a, uint32_t* b) {
+				for (unsigned int lane = 0; lane < 4; ++lane) {
+					a[lane] = u;
+					b[lane] = v;
+					u += R2_STEP_U;
+					v += R2_STEP_V;
+				}
+			}
+		};
+
+		float scalar_unit_from_bits(uint32_t bits) {
+			return float(bits >> 8) * UNIT_FROM_BITS;
+		}
+
+		template <typename Source>
+		void fill_points_scalar(Source& source, const SphereMapping& mapping, size_t count, float* x, float* y, float* z) {
+			for (size_t i = 0; i < count; i += 4) {
+				uint32_t a_bits[4], b_bits[4];
+				source.next(a_bits, b_bits);
+
+				const size_t lanes = std::min<size_t>(count - i, 4);
+				for (size_t lane = 0; lane < lanes; ++lane) {
+					const float py = scalar_unit_from_bits(a_bits[lane]) * mapping.y_scale + mapping.y_offset;
+					const float longitude = scalar_unit_from_bits(b_bits[lane]) * two_pi;
+					const float cos_latitude = std::sqrt(std::max(1.0f - py * py, 0.0f));
+					float s, c;
+					fast_sincos(longitude, s, c);
+					x[i + lane] = cos_latitude * c;
+					y[i + lane] = py;
+					z[i + lane] = cos_latitude * s;
+				}
+			}
+		}
+
+#ifdef YKS_HAS_SSE2
+		struct RandomSource {
+			__m128i s0, s1, s2, s3;
+
+			explicit RandomSource(const SampleRng& rng) {
+				s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rng.state[0]));
+				s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rng.state[1]));
+				s2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rng.state[2]));
+				s3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rng.state[3]));
+			}
+
+			void save(SampleRng& rng) const {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(rng.state[0]), s0);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(rng.state[1]), s1);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(rng.state[2]), s2);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(rng.state[3]), s3);
+			}
+
+			__m128i next_bits() {
+				const __m128i result = _mm_add_epi32(s0, s3);
+				const __m128i t = _mm_slli_epi32(s1, 9);
+				s2 = _mm_xor_si128(s2, s0);
+				s3 = _mm_xor_si128(s3, s1);
+				s1 = _mm_xor_si128(s1, s2);
+				s0 = _mm_xor_si128(s0, s3);
+				s2 = _mm_xor_si128(s2, t);
+				s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+				return result;
+			}
+
+			void next(__m128i& a, __m128i& b) {
+				a = next_bits();
+				b = next_bits();
+			}
+		};
+
+		struct R2Source {
+			__m128i u, v;
+
+			explicit R2Source(size_t first) {
+				const uint32_t n = uint32_t(first);
+				u = _mm_add_epi32(_mm_set1_epi32(int(R2_OFFSET + n * R2_STEP_U)),
+					_mm_setr_epi32(0, int(R2_STEP_U), int(2 * R2_STEP_U), int(3 * R2_STEP_U)));
+				v = _mm_add_epi32(_mm_set1_epi32(int(R2_OFFSET + n * R2_STEP_V)),
+					_mm_setr_epi32(0, int(R2_STEP_V), int(2 * R2_STEP_V), int(3 * R2_STEP_V)));
+			}
+
+			void next(__m128i& a, __m128i& b) {
+				a = u;
+				b = v;
+				u = _mm_add_epi32(u, _mm_set1_epi32(int(4 * R2_STEP_U)));
+				v = _mm_add_epi32(v, _mm_set1_epi32(int(4 * R2_STEP_V)));
+			}
+		};
+
+		__m128 unit_from_bits(__m128i bits) {
+			return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(bits, 8)), _mm_set1_ps(UNIT_FROM_BITS));
+		}
+
+		template <typename Source>
+		void fill_points(Source& source, const SphereMapping& mapping, size_t count, float* x, float* y, float* z) {
+			const __m128 y_scale = _mm_set1_ps(mapping.y_scale);
+			const __m128 y_offset = _mm_set1_ps(mapping.y_offset);
+
+			for (size_t i = 0; i < count; i += 4) {
+				__m128i a_bits, b_bits;
+				source.next(a_bits, b_bits);
+
+				const __m128 py = _mm_add_ps(_mm_mul_ps(unit_from_bits(a_bits), y_scale), y_offset);
+				const __m128 longitude = _mm_mul_ps(unit_from_bits(b_bits), _mm_set1_ps(two_pi));
+				const __m128 cos_latitude = _mm_sqrt_ps(_mm_max_ps(
+					_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(py, py)), _mm_setzero_ps()));
+				__m128 s, c;
+				fast_sincos(longitude, s, c);
+				const __m128 px = _mm_mul_ps(cos_latitude, c);
+				const __m128 pz = _mm_mul_ps(cos_latitude, s);
+
+				if (count - i >= 4) {
+					_mm_storeu_ps(x + i, px);
+					_mm_storeu_ps(y + i, py);
+					_mm_storeu_ps(z + i, pz);
+				} else {
+					float tail_x[4], tail_y[4], tail_z[4];
+					_mm_storeu_ps(tail_x, px);
+					_mm_storeu_ps(tail_y, py);
+					_mm_storeu_ps(tail_z, pz);
+					std::copy(tail_x, tail_x + (count - i), x + i);
+					std::copy(tail_y, tail_y + (count - i), y + i);
+					std::copy(tail_z, tail_z + (count - i), z + i);
+				}
+			}
+		}
+#else
+		typedef ScalarRandomSource RandomSource;
+		typedef ScalarR2Source R2Source;
+
+		template <typename Source>
+		void fill_points(Source& source, const SphereMapping& mapping, size_t count, float* x, float* y, float* z) {
+			fill_points_scalar(source, mapping, count, x, y, z);
+		}
+#endif
+
+		void fill_random_points(SampleRng& rng, const SphereMapping& mapping, size_t count, float* x, float* y, float* z) {
+			RandomSource source(rng);
+			fill_points(source, mapping, count, x, y, z);
+			source.save(rng);
+		}
+
+		void fill_r2_points(size_t first, const SphereMapping& mapping, size_t count, float* x, float* y, float* z) {
+			R2Source source(first);
+			fill_points(source, mapping, count, x, y, z);
+		}
+	}
+
+	SampleRng::SampleRng(uint64_t seed, uint64_t stream) {
+		// Each stream takes 8 consecutive splitmix64 outputs, so different
+		// streams never share any
+		uint64_t x = seed + stream * 8 * 0x9E3779B97F4A7C15ull;
+		for (unsigned int lane = 0; lane < 4; ++lane) {
+			const uint64_t lo = splitmix64(x);
+			const uint64_t hi = splitmix64(x);
+			state[0][lane] = uint32_t(lo);
+			state[1][lane] = uint32_t(lo >> 32);
+			state[2][lane] = uint32_t(hi);
+			state[3][lane] = uint32_t(hi >> 32);
+			// xoshiro gets stuck on a state of all zeros
+			if ((lo | hi) == 0) {
+				state[0][lane] = 1;
+			}
+		}
+	}
+
+	void random_points_on_sphere(SampleRng& rng, size_t count, float* x, float* y, float* z) {
+		fill_random_points(rng, SPHERE, count, x, y, z);
+	}
+
+	void random_points_on_hemisphere(SampleRng& rng, size_t count, float* x, float* y, float* z) {
+		fill_random_points(rng, HEMISPHERE, count, x, y, z);
+	}
+
+	void r2_points_on_sphere(size_t first, size_t count, float* x, float* y, float* z) {
+		fill_r2_points(first, SPHERE, count, x, y, z);
+	}
+
+	void r2_points_on_hemisphere(size_t first, size_t count, float* x, float* y, float* z) {
+		fill_r2_points(first, HEMISPHERE, count, x, y, z);
+	}
+
+	namespace sampling_detail {
+		void random_points_scalar(SampleRng& rng, bool hemisphere, size_t count, float* x, float* y, float* z) {
+			ScalarRandomSource source(rng);
+			fill_points_scalar(source, hemisphere ? HEMISPHERE : SPHERE, count, x, y, z);
+		}
+
+		void r2_points_scalar(size_t first, bool hemisphere, size_t count, float* x, float* y, float* z) {
+			ScalarR2Source source(first);
+			fill_points_scalar(source, hemisphere ? HEMISPHERE : SPHERE, count, x, y, z);
+		}
+	}
+
+}
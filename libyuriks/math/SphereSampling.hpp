@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace yks {
+
+	/// Four xoshiro128+ generators, one per SIMD lane, for the random_points_*
+	/// functions. Generators made with the same seed and different streams
+	/// give independent sequences, so parallel workers can each have one.
+	struct SampleRng {
+		explicit SampleRng(uint64_t seed, uint64_t stream = 0);
+
+		/// State word, then lane.
+		uint32_t state[4][4];
+	};
+
+	/// Fills x, y and z with count points uniformly distributed on the unit
+	/// sphere, the same way uniform_point_on_sphere does, 4 at a time with
+	/// SSE2.
+	void random_points_on_sphere(SampleRng& rng, size_t count, float* x, float* y, float* z);
+	/// Same as random_points_on_sphere, but only on the half where y >= 0.
+	void random_points_on_hemisphere(SampleRng& rng, size_t count, float* x, float* y, float* z);
+
+	/// Fills x, y and z with points first to first + count - 1 of the R2
+	/// low-discrepancy sequence, mapped to the unit sphere. Points cover the
+	/// sphere more evenly than random ones, and splitting the index range
+	/// gives parallel workers different points. The sequence repeats after
+	/// 2^32 points.
+	void r2_points_on_sphere(size_t first, size_t count, float* x, float* y, float* z);
+	/// Same as r2_points_on_sphere, but only on the half where y >= 0.
+	void r2_points_on_hemisphere(size_t first, size_t count, float* x, float* y, float* z);
+
+	namespace sampling_detail {
+		/// The versions of the functions above used when SSE2 isn't
+		/// available, giving the same points. Always built, so that the
+		/// benchmarks can compare them.
+		void random_points_scalar(SampleRng& rng, bool hemisphere, size_t count, float* x, float* y, float* z);
+		void r2_points_scalar(size_t first, bool hemisphere, size_t count, float* x, float* y, float* z);
+	}
+
+}
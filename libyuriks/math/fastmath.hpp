@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include "simd.hpp"
+
+// Approximations of sin, cos, exp2, log2 and pow for hot code that doesn't
+// need the last bit of precision. sin and cos come in a scalar version and an
+// SSE2 version working on 4 floats. Only the SSE2 versions are much faster
+// than the C library: the scalar sin and cos are only about 1.5x faster than
+// std::sin and std::cos, so code calling them in a loop should use the SSE2
+// versions instead.
+// exp2, log2 and pow only come in the SSE2 version, since C libraries often
+// have table based ones that are faster than these one float at a time.
+//
+// The build uses -ffast-math, which would fold the parts of pi/2 in the sin
+// and cos range reduction back together, so those steps are pinned with
+// noReassociate.
+//
+// Maximum errors with the build's flags, measured over the whole documented
+// input range (bench/fastmath_bench.cpp checks them, and fails if they're
+// exceeded):
+//  - fast_sin, fast_cos: 1e-7 absolute for |x| <= 8192. Larger inputs lose
+//    precision in the range reduction.
+//  - fast_exp2: 1.1e-7 relative. x is clamped to [-126, 127.5).
+//  - fast_log2: 1.2e-7 * max(1, |log2(x)|) absolute, for positive normal x.
+//  - fast_pow: 1e-7 * (1 + |y*log2(x)|) relative, for positive normal x with
+//    y*log2(x) inside the range of fast_exp2.
+
+namespace yks {
+
+	namespace fastmath_detail {
+		// pi/2 split so that q*PIO2_1 and q*PIO2_2 are exact for reasonable q
+		static const float PIO2_1 = 1.5703125f;
+		static const float PIO2_2 = 4.837512969970703125e-4f;
+		static const float PIO2_3 = 7.54978995489188216e-8f;
+		static const float TWO_OVER_PI = 0.636619772367581343f;
+
+		// Minimax polynomials on [-pi/4, pi/4], from Cephes
+		static const float SIN_C1 = -1.6666654611e-1f;
+		static const float SIN_C2 = 8.3321608736e-3f;
+		static const float SIN_C3 = -1.9515295891e-4f;
+		static const float COS_C1 = 4.166664568298827e-2f;
+		static const float COS_C2 = -1.388731625493765e-3f;
+		static const float COS_C3 = 2.443315711809948e-5f;
+
+		// Minimax polynomial for 2^x - 1 on [-0.5, 0.5], from Cephes
+		static const float EXP2_C0 = 6.931472028550421e-1f;
+		static const float EXP2_C1 = 2.402264791363012e-1f;
+		static const float EXP2_C2 = 5.550332471162809e-2f;
+		static const float EXP2_C3 = 9.618437357674640e-3f;
+		static const float EXP2_C4 = 1.339887440266574e-3f;
+		static const float EXP2_C5 = 1.535336188319500e-4f;
+		static const float EXP2_MIN = -126.0f;
+		static const float EXP2_MAX = 127.49999f;
+
+		// Minimax polynomial for log(1 + z) on [sqrt(2)/2 - 1, sqrt(2) - 1],
+		// from Cephes
+		static const float LOG_C0 = 7.0376836292e-2f;
+		static const float LOG_C1 = -1.1514610310e-1f;
+		static const float LOG_C2 = 1.1676998740e-1f;
+		static const float LOG_C3 = -1.2420140846e-1f;
+		static const float LOG_C4 = 1.4249322787e-1f;
+		static const float LOG_C5 = -1.6668057665e-1f;
+		static const float LOG_C6 = 2.0000714765e-1f;
+		static const float LOG_C7 = -2.4999993993e-1f;
+		static const float LOG_C8 = 3.3333331174e-1f;
+		static const float LOG2_E = 1.44269504088896341f;
+		static const float SQRT2 = 1.41421356237309505f;
+
+		inline uint32_t bits_from_float(float f) {
+			uint32_t u;
+			std::memcpy(&u, &f, sizeof(u));
+			return u;
+		}
+
+		inline float float_from_bits(uint32_t u) {
+			float f;
+			std::memcpy(&f, &u, sizeof(f));
+			return f;
+		}
+
+		/** Round to nearest with halves away from zero. Done with bit operations,
+		 * since a branch on the sign mispredicts on random inputs. */
+		inline int round_to_int(float x) {
+			const float half = float_from_bits(bits_from_float(0.5f) | (bits_from_float(x) & 0x80000000));
+			return static_cast<int>(x + half);
+		}
+
+		/** sin and cos of r, |r| <= pi/4. */
+		inline void sincos_reduced(float r, float& s, float& c) {
+			const float r2 = r * r;
+			s = r + r * r2 * (SIN_C1 + r2 * (SIN_C2 + r2 * SIN_C3));
+			c = 1.0f - 0.5f * r2 + r2 * r2 * (COS_C1 + r2 * (COS_C2 + r2 * COS_C3));
+		}
+
+		/** Splits x into q*pi/2 + r, with r in [-pi/4, pi/4]. */
+		inline float reduce_quadrant(float x, int& q) {
+			q = round_to_int(x * TWO_OVER_PI);
+			const float qf = static_cast<float>(q);
+			const float r = noReassociate(x - qf * PIO2_1);
+			return noReassociate(r - qf * PIO2_2) - qf * PIO2_3;
+		}
+	}
+
+	inline void fast_sincos(float x, float& s, float& c) {
+		using namespace fastmath_detail;
+		int q;
+		float rs, rc;
+		sincos_reduced(reduce_quadrant(x, q), rs, rc);
+
+		// Rotate by the quadrant, without branches for the same reason as above
+		const uint32_t swap = 0u - static_cast<uint32_t>(q & 1);
+		const uint32_t rs_bits = bits_from_float(rs);
+		const uint32_t rc_bits = bits_from_float(rc);
+		const uint32_t sin_sign = static_cast<uint32_t>(q & 2) << 30;
+		const uint32_t cos_sign = static_cast<uint32_t>((q + 1) & 2) << 30;
+		s = float_from_bits(((rc_bits & swap) | (rs_bits & ~swap)) ^ sin_sign);
+		c = float_from_bits(((rs_bits & swap) | (rc_bits & ~swap)) ^ cos_sign);
+	}
+
+	inline float fast_sin(float x) {
+		float s, c;
+		fast_sincos(x, s, c);
+		return s;
+	}
+
+	inline float fast_cos(float x) {
+		float s, c;
+		fast_sincos(x, s, c);
+		return c;
+	}
+
+#ifdef YKS_HAS_SSE2
+	namespace fastmath_detail {
+		inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		}
+
+		/** Round to nearest with halves away from zero, like the scalar code. */
+		inline __m128i round_to_int(__m128 x) {
+			const __m128 half = _mm_or_ps(_mm_set1_ps(0.5f), _mm_and_ps(x, _mm_set1_ps(-0.0f)));
+			return _mm_cvttps_epi32(_mm_add_ps(x, half));
+		}
+	}
+
+	inline void fast_sincos(__m128 x, __m128& s, __m128& c) {
+		using namespace fastmath_detail;
+		const __m128i q = round_to_int(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));
+		const __m128 qf = _mm_cvtepi32_ps(q);
+		__m128 r = noReassociate(_mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(PIO2_1))));
+		r = noReassociate(_mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(PIO2_2))));
+		r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(PIO2_3)));
+
+		const __m128 r2 = _mm_mul_ps(r, r);
+		__m128 ps = _mm_add_ps(_mm_set1_ps(SIN_C2), _mm_mul_ps(r2, _mm_set1_ps(SIN_C3)));
+		ps = _mm_add_ps(_mm_set1_ps(SIN_C1), _mm_mul_ps(r2, ps));
+		const __m128 rs = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), ps));
+		__m128 pc = _mm_add_ps(_mm_set1_ps(COS_C2), _mm_mul_ps(r2, _mm_set1_ps(COS_C3)));
+		pc = _mm_add_ps(_mm_set1_ps(COS_C1), _mm_mul_ps(r2, pc));
+		const __m128 rc = _mm_add_ps(
+			_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)),
+			_mm_mul_ps(_mm_mul_ps(r2, r2), pc));
+
+		const __m128i one = _mm_set1_epi32(1);
+		const __m128i two = _mm_set1_epi32(2);
+		const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+		const __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+		const __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+		s = _mm_xor_ps(select(swap, rc, rs), sin_sign);
+		c = _mm_xor_ps(select(swap, rs, rc), cos_sign);
+	}
+
+	inline __m128 fast_sin(__m128 x) {
+		__m128 s, c;
+		fast_sincos(x, s, c);
+		return s;
+	}
+
+	inline __m128 fast_cos(__m128 x) {
+		__m128 s, c;
+		fast_sincos(x, s, c);
+		return c;
+	}
+
+	inline __m128 fast_exp2(__m128 x) {
+		using namespace fastmath_detail;
+		x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(EXP2_MIN)), _mm_set1_ps(EXP2_MAX));
+
+		const __m128i i = round_to_int(x);
+		const __m128 f = _mm_sub_ps(x, _mm_cvtepi32_ps(i));
+		__m128 p = _mm_add_ps(_mm_set1_ps(EXP2_C4), _mm_mul_ps(f, _mm_set1_ps(EXP2_C5)));
+		p = _mm_add_ps(_mm_set1_ps(EXP2_C3), _mm_mul_ps(f, p));
+		p = _mm_add_ps(_mm_set1_ps(EXP2_C2), _mm_mul_ps(f, p));
+		p = _mm_add_ps(_mm_set1_ps(EXP2_C1), _mm_mul_ps(f, p));
+		p = _mm_add_ps(_mm_set1_ps(EXP2_C0), _mm_mul_ps(f, p));
+		p = _mm_mul_ps(f, p);
+
+		const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(i, _mm_set1_epi32(127)), 23));
+		return _mm_mul_ps(_mm_add_ps(_mm_set1_ps(1.0f), p), scale);
+	}
+
+	inline __m128 fast_log2(__m128 x) {
+		using namespace fastmath_detail;
+		const __m128i u = _mm_castps_si128(x);
+		__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(u, 23), _mm_set1_epi32(127)));
+		__m128 m = _mm_castsi128_ps(_mm_or_si128(
+			_mm_and_si128(u, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+
+		const __m128 above = _mm_cmpgt_ps(m, _mm_set1_ps(SQRT2));
+		m = select(above, _mm_mul_ps(m, _mm_set1_ps(0.5f)), m);
+		e = _mm_add_ps(e, _mm_and_ps(above, _mm_set1_ps(1.0f)));
+
+		const __m128 z = _mm_sub_ps(m, _mm_set1_ps(1.0f));
+		__m128 p = _mm_set1_ps(LOG_C0);
+		p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(LOG_C1));
+		p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(LOG_C2));
+		p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(LOG_C3));
+		p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(LOG_C4));
+		p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(LOG_C5));
+		p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(LOG_C6));
+		p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(LOG_C7));
+		p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(LOG_C8));
+		const __m128 z2 = _mm_mul_ps(z, z);
+		const __m128 ln = _mm_add_ps(z, _mm_mul_ps(z2, _mm_sub_ps(_mm_mul_ps(z, p), _mm_set1_ps(0.5f))));
+		return _mm_add_ps(e, _mm_mul_ps(ln, _mm_set1_ps(LOG2_E)));
+	}
+
+	inline __m128 fast_pow(__m128 x, __m128 y) {
+		return fast_exp2(_mm_mul_ps(y, fast_log2(x)));
+	}
+#endif
+
+}
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <cmath>
 #include "vec.hpp"
+#include "simd.hpp"
 
 namespace yks {
 
@@ -162,6 +163,60 @@ namespace yks {
 		return vr;
 	}
 
+#ifdef YKS_HAS_SSE2
+	// SSE2 versions of the above for mat4 and vec4, picked over the templates
+	// by overload resolution. They add the products left to right, in the
+	// order the generic loops are written, and pass their partial sums
+	// through noReassociate so that -ffast-math doesn't change it. The
+	// generic loops are left free to be reordered, so the two can differ in
+	// the last bits.
+	// vec4 isn't 16 byte aligned (32-bit MSVC can't pass aligned types by
+	// value), so the loads are unaligned ones.
+
+	inline mat4 operator *(const mat4& a, const mat4& b) {
+		const __m128 b0 = _mm_loadu_ps(&b.data[0][0]);
+		const __m128 b1 = _mm_loadu_ps(&b.data[1][0]);
+		const __m128 b2 = _mm_loadu_ps(&b.data[2][0]);
+		const __m128 b3 = _mm_loadu_ps(&b.data[3][0]);
+
+		mat4 vr;
+		for (unsigned int m = 0; m < 4; ++m) {
+			__m128 s = noReassociate(_mm_mul_ps(_mm_set1_ps(a(m,0)), b0));
+			s = noReassociate(_mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(a(m,1)), b1)));
+			s = noReassociate(_mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(a(m,2)), b2)));
+			s = _mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(a(m,3)), b3));
+			_mm_storeu_ps(&vr.data[m][0], s);
+		}
+		return vr;
+	}
+
+	inline vec4 operator *(const mat4& m, const vec4 v) {
+		const __m128 vv = _mm_loadu_ps(&v[0]);
+		__m128 p0 = _mm_mul_ps(_mm_loadu_ps(&m.data[0][0]), vv);
+		__m128 p1 = _mm_mul_ps(_mm_loadu_ps(&m.data[1][0]), vv);
+		__m128 p2 = _mm_mul_ps(_mm_loadu_ps(&m.data[2][0]), vv);
+		__m128 p3 = _mm_mul_ps(_mm_loadu_ps(&m.data[3][0]), vv);
+		// Transposing turns the horizontal sums of each row into vertical ones
+		_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+		vec4 vr;
+		const __m128 s = noReassociate(_mm_add_ps(noReassociate(_mm_add_ps(p0, p1)), p2));
+		_mm_storeu_ps(&vr[0], _mm_add_ps(s, p3));
+		return vr;
+	}
+
+	inline vec4 operator *(const vec4 v, const mat4& m) {
+		__m128 s = noReassociate(_mm_mul_ps(_mm_set1_ps(v[0]), _mm_loadu_ps(&m.data[0][0])));
+		s = noReassociate(_mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(v[1]), _mm_loadu_ps(&m.data[1][0]))));
+		s = noReassociate(_mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(v[2]), _mm_loadu_ps(&m.data[2][0]))));
+		s = _mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(v[3]), _mm_loadu_ps(&m.data[3][0])));
+
+		vec4 vr;
+		_mm_storeu_ps(&vr[0], s);
+		return vr;
+	}
+#endif
+
 	// Column vector version
 	template<unsigned int N, typename T>
 	inline vec<N,T> vec_from_mat(const mat<N,1,T>& m) {
@@ -193,6 +248,23 @@ namespace yks {
 		return t;
 	}
 
+#ifdef YKS_HAS_SSE2
+	inline mat4 transpose(const mat4& m) {
+		__m128 r0 = _mm_loadu_ps(&m.data[0][0]);
+		__m128 r1 = _mm_loadu_ps(&m.data[1][0]);
+		__m128 r2 = _mm_loadu_ps(&m.data[2][0]);
+		__m128 r3 = _mm_loadu_ps(&m.data[3][0]);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		mat4 t;
+		_mm_storeu_ps(&t.data[0][0], r0);
+		_mm_storeu_ps(&t.data[1][0], r1);
+		_mm_storeu_ps(&t.data[2][0], r2);
+		_mm_storeu_ps(&t.data[3][0], r3);
+		return t;
+	}
+#endif
+
 	template<unsigned int DN, unsigned int SN, typename T>
 	mat<DN,DN,T> pad(const mat<SN,SN,T>& m) {
 		mat<DN,DN,T> rm;
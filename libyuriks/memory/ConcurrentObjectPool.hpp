@@ -0,0 +1,210 @@
+#pragma once
+#include "Handle.hpp"
+#include "noncopyable.hpp"
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace yks {
+
+	/** Pool of objects which can be inserted into and removed from by many
+	 * threads at once, providing persistent handles to them.
+	 *
+	 * Unlike ObjectPool, objects never move: slots live in chunks which are
+	 * allocated as needed and never freed until the pool is destroyed, so
+	 * lookups stay valid while other threads grow the pool. Freed slots go on
+	 * a lock-free free list, tagged to avoid ABA problems.
+	 *
+	 * Looking up an object is safe at any time, but using it while another
+	 * thread removes it is a race, same as with any other object. */
+	template <typename T, typename H = Handle>
+	struct ConcurrentObjectPool {
+		static constexpr size_t chunk_shift = 10;
+		static constexpr size_t chunk_size = size_t(1) << chunk_shift;
+		static constexpr size_t max_chunks = 4096;
+		static constexpr size_t max_objects = chunk_size * max_chunks;
+		static_assert(max_objects <= H::null_index, "Handle type can't index the whole pool");
+
+		ConcurrentObjectPool()
+			: free_head(pack(null_slot, 0)), num_used_slots(0)
+		{
+			for (std::atomic<Slot*>& chunk : chunks) {
+				chunk.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		~ConcurrentObjectPool() {
+			for (std::atomic<Slot*>& chunk_ptr : chunks) {
+				Slot* chunk = chunk_ptr.load(std::memory_order_relaxed);
+				if (chunk == nullptr)
+					continue;
+
+				for (size_t i = 0; i < chunk_size; ++i) {
+					if (isLive(chunk[i].generation.load(std::memory_order_relaxed))) {
+						chunk[i].object()->~T();
+					}
+				}
+				delete[] chunk;
+			}
+		}
+
+		/** Constructs a new object, returning a null handle if the pool is full. */
+		template <typename... Args>
+		H emplace(Args&&... params) {
+			const uint32_t index = allocateSlot();
+			if (index == null_slot)
+				return H();
+
+			Slot& slot = getSlot(index);
+			new (slot.storage) T(std::forward<Args>(params)...);
+
+			// Odd generations mark live objects. Publishing it makes the object
+			// visible to lookups.
+			const uint32_t generation = slot.generation.load(std::memory_order_relaxed) + 1;
+			slot.generation.store(generation, std::memory_order_release);
+			return H(index, generation);
+		}
+
+		/** Removes the object, if the handle is still valid. If several threads
+		 * remove the same object only one of them does it. */
+		void remove(const H h) {
+			if (h.index >= num_used_slots.load(std::memory_order_acquire))
+				return;
+
+			Slot& slot = getSlot(static_cast<uint32_t>(h.index));
+			uint32_t generation = slot.generation.load(std::memory_order_acquire);
+			if (!isLive(generation) || !matches(generation, h))
+				return;
+
+			// Claim the object by retiring its generation
+			if (!slot.generation.compare_exchange_strong(generation, generation + 1, std::memory_order_acq_rel))
+				return;
+
+			slot.object()->~T();
+			freeSlot(static_cast<uint32_t>(h.index));
+		}
+
+		T* operator[] (const H h) {
+			return const_cast<T*>(static_cast<const ConcurrentObjectPool&>(*this)[h]);
+		}
+
+		const T* operator[] (const H h) const {
+			if (!isValid(h))
+				return nullptr;
+			return getSlot(static_cast<uint32_t>(h.index)).object();
+		}
+
+		/** Checks if object referenced by handle is still in the pool. */
+		bool isValid(const H h) const {
+			if (h.index >= num_used_slots.load(std::memory_order_acquire))
+				return false;
+
+			const uint32_t generation = getSlot(static_cast<uint32_t>(h.index)).generation.load(std::memory_order_acquire);
+			return isLive(generation) && matches(generation, h);
+		}
+
+		/** Calls f(handle, object) for every object in the pool. Must not run
+		 * concurrently with inserts or removals. */
+		template <typename F>
+		void forEach(F&& f) {
+			const size_t num_slots = num_used_slots.load(std::memory_order_acquire);
+			for (size_t i = 0; i < num_slots; ++i) {
+				Slot& slot = getSlot(static_cast<uint32_t>(i));
+				const uint32_t generation = slot.generation.load(std::memory_order_relaxed);
+				if (isLive(generation)) {
+					f(H(i, generation), *slot.object());
+				}
+			}
+		}
+
+	private:
+		static constexpr uint32_t null_slot = UINT32_MAX;
+
+		struct Slot {
+			std::atomic<uint32_t> generation; // Odd while the slot holds an object
+			std::atomic<uint32_t> next_free;
+			alignas(T) unsigned char storage[sizeof(T)];
+
+			T* object() { return reinterpret_cast<T*>(storage); }
+			const T* object() const { return reinterpret_cast<const T*>(storage); }
+		};
+
+		// Head slot index in the low half, modification count in the high half
+		std::atomic<uint64_t> free_head;
+		// Slots below this have been handed out at least once
+		std::atomic<size_t> num_used_slots;
+		std::atomic<Slot*> chunks[max_chunks];
+
+		static uint64_t pack(uint32_t index, uint32_t tag) {
+			return uint64_t(tag) << 32 | index;
+		}
+
+		static bool isLive(uint32_t generation) {
+			return (generation & 1) != 0;
+		}
+
+		/** Compares generations, as truncated to the bits stored in handles. */
+		static bool matches(uint32_t generation, const H h) {
+			return H(h.index, generation).generation == h.generation;
+		}
+
+		Slot& getSlot(uint32_t index) const {
+			Slot* chunk = chunks[index >> chunk_shift].load(std::memory_order_acquire);
+			assert(chunk != nullptr);
+			return chunk[index & (chunk_size - 1)];
+		}
+
+		uint32_t allocateSlot() {
+			// Reuse a freed slot if possible
+			uint64_t head = free_head.load(std::memory_order_acquire);
+			while (uint32_t(head) != null_slot) {
+				const uint32_t index = uint32_t(head);
+				// The slot may be popped and reused by another thread meanwhile,
+				// making this stale, but then the tag will have changed too.
+				const uint32_t next = getSlot(index).next_free.load(std::memory_order_relaxed);
+				if (free_head.compare_exchange_weak(head, pack(next, uint32_t(head >> 32) + 1),
+					std::memory_order_acquire, std::memory_order_acquire))
+				{
+					return index;
+				}
+			}
+
+			// Otherwise take a new one, allocating its chunk if needed
+			size_t new_index = num_used_slots.load(std::memory_order_relaxed);
+			do {
+				if (new_index >= max_objects)
+					return null_slot; // TODO: ERROR_CHECK
+				ensureChunk(new_index >> chunk_shift);
+			} while (!num_used_slots.compare_exchange_weak(new_index, new_index + 1, std::memory_order_acq_rel));
+
+			return static_cast<uint32_t>(new_index);
+		}
+
+		void freeSlot(uint32_t index) {
+			Slot& slot = getSlot(index);
+			uint64_t head = free_head.load(std::memory_order_relaxed);
+			do {
+				slot.next_free.store(uint32_t(head), std::memory_order_relaxed);
+			} while (!free_head.compare_exchange_weak(head, pack(index, uint32_t(head >> 32) + 1),
+				std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		void ensureChunk(size_t chunk_index) {
+			if (chunks[chunk_index].load(std::memory_order_acquire) != nullptr)
+				return;
+
+			// Several threads may race to allocate the chunk; losers free theirs.
+			Slot* new_chunk = new Slot[chunk_size]();
+			Slot* expected = nullptr;
+			if (!chunks[chunk_index].compare_exchange_strong(expected, new_chunk, std::memory_order_acq_rel)) {
+				delete[] new_chunk;
+			}
+		}
+
+		NONCOPYABLE(ConcurrentObjectPool);
+	};
+
+}
@@ -1,43 +1,236 @@
 #pragma once
 #include "DynamicPoolAllocator.hpp"
 #include "Handle.hpp"
+#include "Span.hpp"
+#include "PoolRoster.hpp"
+#include "PoolStats.hpp"
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 namespace yks {
 
-	/** Manages a pool of objects, providing persistent handles to them. */
-	struct DynamicPool {
-		size_t first_free_index = SIZE_MAX; // in roster
-
-		// For used entries: .index is index into pool.
-		// For free entries: .index is index of next free entry.
-		std::vector<Handle> roster;
+	/** Manages a pool of objects, providing persistent handles to them.
+	 * H is Handle or a PackedHandle, which limits how many objects the pool
+	 * can hold. */
+	template <typename H>
+	struct BasicDynamicPool : private PoolStatsTracker, public PoolRoster<H> {
+		using PoolRoster<H>::first_free_index;
+		using PoolRoster<H>::roster;
+		using PoolRoster<H>::pool_indices;
+		using PoolRoster<H>::isValid;
 
 		DynamicPoolAllocator pool;
-		std::vector<size_t> pool_indices;
 
-		DynamicPool(size_t object_size);
+		BasicDynamicPool(size_t object_size, size_t alignment = 1,
+			PoolGrowth growth = PoolGrowth::contiguous);
 
-		std::tuple<Handle, void*> insert(const void* object);
-		void remove(const Handle h);
+		std::tuple<H, void*> insert(const void* object);
+		/** Inserts count objects from an array with getObjectSize() stride,
+		 * writing their handles to out_handles. */
+		void insertBulk(const void* objects, size_t count, H* out_handles);
+		void remove(const H h);
 
-		void* operator[] (const Handle h);
-		const void* operator[] (const Handle h) const;
+		size_t size() const { return pool.size(); }
 
-		/** Checks if object referenced by handle is still in the pool. */
-		bool isValid(const Handle h) const;
+		PoolStats getStats() const;
 
-		/** Creates a handle to the object currently at pool[index]. */
-		Handle makeHandle(size_t index) const;
+		/** Bytes needed to snapshot the pool in its current state. */
+		size_t getSnapshotSize() const;
+		/** Copies the whole pool state (objects, roster, free list) into
+		 * buffer. Returns the number of bytes written, or 0 if the buffer is
+		 * smaller than getSnapshotSize(). */
+		size_t snapshot(void* buffer, size_t buffer_size) const;
+		/** Replaces the pool state with a snapshot taken from a pool with the
+		 * same object and handle types. Handles that were valid when the
+		 * snapshot was taken become valid again, while handles obtained
+		 * after it must be discarded, since they can alias restored objects.
+		 * Returns false, leaving the pool unchanged, if the snapshot doesn't
+		 * match this pool or its roster is inconsistent. Object contents and
+		 * generations can't be checked, so a tampered snapshot can still make
+		 * old handles valid again. */
+		bool restore(const void* buffer, size_t buffer_size);
 
-		/** Get index into pool for handle. */
-		size_t getPoolIndex(const Handle h) const;
+		void* operator[] (const H h);
+		const void* operator[] (const H h) const;
 
 	private:
-		void expand_roster();
+		struct SnapshotHeader {
+			uint32_t handle_size;
+			uint32_t object_stride;
+			uint64_t first_free_index;
+			uint64_t roster_size;
+			uint64_t pool_size;
+		};
+
+		H bindNewObject();
 	};
 
+	typedef BasicDynamicPool<Handle> DynamicPool;
+
+
+	template <typename H>
+	BasicDynamicPool<H>::BasicDynamicPool(size_t object_size, size_t alignment, PoolGrowth growth)
+		: pool(object_size, alignment, growth)
+	{}
+
+	template <typename H>
+	std::tuple<H, void*> BasicDynamicPool<H>::insert(const void* object) {
+		void* inserted_ptr = nullptr;
+		this->trackGrowth(pool.size() == pool.capacity(), [&] {
+			if (object != nullptr) {
+				inserted_ptr = pool.push_back(object);
+			} else {
+				inserted_ptr = pool.push_back();
+			}
+		});
+
+		return std::make_tuple(bindNewObject(), inserted_ptr);
+	}
+
+	template <typename H>
+	void BasicDynamicPool<H>::insertBulk(const void* objects, size_t count, H* out_handles) {
+		this->trackGrowth(pool.size() + count > pool.capacity(), [&] {
+			pool.reserve(pool.size() + count);
+		});
+		this->reserveEntries(count);
+
+		const uint8_t* src = static_cast<const uint8_t*>(objects);
+		for (size_t i = 0; i < count; ++i) {
+			pool.push_back(src + i * pool.getObjectSize());
+			out_handles[i] = bindNewObject();
+		}
+	}
+
+	template <typename H>
+	void BasicDynamicPool<H>::remove(const H h) {
+		if (this->unbind(h, [this](size_t from, size_t to) { pool.copy(from, to); })) {
+			pool.pop_back();
+		}
+	}
+
+	template <typename H>
+	PoolStats BasicDynamicPool<H>::getStats() const {
+		PoolStats stats;
+		stats.object_size = pool.getObjectSize();
+		stats.live = pool.size();
+		stats.roster_size = roster.size();
+		stats.capacity = pool.capacity();
+		stats.free_list_length = roster.size() - pool.size();
+		stats.slack_bytes = (pool.capacity() - pool.size()) * pool.getStride() + this->getRosterSlackBytes();
+		this->fillTrackedStats(stats);
+		return stats;
+	}
+
+	template <typename H>
+	size_t BasicDynamicPool<H>::getSnapshotSize() const {
+		return sizeof(SnapshotHeader) + roster.size() * sizeof(H) +
+			pool.size() * (sizeof(typename H::index_type) + pool.getStride());
+	}
+
+	template <typename H>
+	size_t BasicDynamicPool<H>::snapshot(void* buffer, size_t buffer_size) const {
+		static_assert(std::is_trivially_copyable<H>::value, "Handle must be trivially copyable");
+
+		const size_t snapshot_size = getSnapshotSize();
+		if (buffer_size < snapshot_size)
+			return 0;
+
+		SnapshotHeader header;
+		header.handle_size = sizeof(H);
+		header.object_stride = static_cast<uint32_t>(pool.getStride());
+		header.first_free_index = first_free_index;
+		header.roster_size = roster.size();
+		header.pool_size = pool.size();
+
+		// Sections are unaligned and only accessed through memcpy
+		uint8_t* out = static_cast<uint8_t*>(buffer);
+		std::memcpy(out, &header, sizeof(header));
+		out += sizeof(header);
+		if (!roster.empty()) {
+			std::memcpy(out, roster.data(), roster.size() * sizeof(H));
+			out += roster.size() * sizeof(H);
+		}
+		if (!pool_indices.empty()) {
+			std::memcpy(out, pool_indices.data(), pool_indices.size() * sizeof(typename H::index_type));
+			out += pool_indices.size() * sizeof(typename H::index_type);
+		}
+		pool.copyTo(out);
+
+		return snapshot_size;
+	}
+
+	template <typename H>
+	bool BasicDynamicPool<H>::restore(const void* buffer, size_t buffer_size) {
+		SnapshotHeader header;
+		if (buffer_size < sizeof(header))
+			return false;
+
+		const uint8_t* in = static_cast<const uint8_t*>(buffer);
+		std::memcpy(&header, in, sizeof(header));
+		in += sizeof(header);
+
+		if (header.handle_size != sizeof(H) || header.object_stride != pool.getStride() ||
+			header.roster_size > buffer_size / sizeof(H) || header.pool_size > header.roster_size ||
+			buffer_size != sizeof(header) + header.roster_size * sizeof(H) +
+				header.pool_size * (sizeof(typename H::index_type) + pool.getStride()))
+		{
+			return false;
+		}
+
+		// Load into copies first, so a bad snapshot leaves the pool as it was
+		std::vector<H> new_roster(static_cast<size_t>(header.roster_size));
+		if (!new_roster.empty()) {
+			std::memcpy(new_roster.data(), in, new_roster.size() * sizeof(H));
+			in += new_roster.size() * sizeof(H);
+		}
+		std::vector<typename H::index_type> new_pool_indices(static_cast<size_t>(header.pool_size));
+		if (!new_pool_indices.empty()) {
+			std::memcpy(new_pool_indices.data(), in, new_pool_indices.size() * sizeof(typename H::index_type));
+			in += new_pool_indices.size() * sizeof(typename H::index_type);
+		}
+		if (header.first_free_index != H::null_index && header.first_free_index >= header.roster_size)
+			return false;
+		if (!PoolRoster<H>::isConsistent(static_cast<size_t>(header.first_free_index), new_roster, new_pool_indices))
+			return false;
+
+		first_free_index = static_cast<size_t>(header.first_free_index);
+		roster.swap(new_roster);
+		pool_indices.swap(new_pool_indices);
+		pool.assign(in, static_cast<size_t>(header.pool_size));
+
+		return true;
+	}
+
+	template <typename H>
+	void* BasicDynamicPool<H>::operator[] (const H h) {
+		if (isValid(h)) {
+			assert(roster[h.index].index < pool.size());
+			return pool[roster[h.index].index];
+		} else {
+			return nullptr;
+		}
+	}
+
+	template <typename H>
+	const void* BasicDynamicPool<H>::operator[] (const H h) const {
+		if (isValid(h)) {
+			assert(roster[h.index].index < pool.size());
+			return pool[roster[h.index].index];
+		} else {
+			return nullptr;
+		}
+	}
+
+	template <typename H>
+	H BasicDynamicPool<H>::bindNewObject() {
+		const H h = PoolRoster<H>::bindNewObject();
+		this->trackSize(pool.size(), roster.size());
+		return h;
+	}
+
 }
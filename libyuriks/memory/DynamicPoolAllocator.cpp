@@ -1,33 +1,107 @@
 #include "DynamicPoolAllocator.hpp"
+#include <cstdlib>
 #include <cstring>
 #include <cassert>
 
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
 namespace yks {
 
-	DynamicPoolAllocator::DynamicPoolAllocator(size_t object_size)
+	static void* alignedAlloc(size_t size, size_t alignment) {
+#ifdef _WIN32
+		return _aligned_malloc(size, alignment);
+#else
+		if (alignment <= alignof(std::max_align_t))
+			return std::malloc(size);
+
+		void* p = nullptr;
+		if (posix_memalign(&p, alignment, size) != 0)
+			return nullptr;
+		return p;
+#endif
+	}
+
+	/** Grows an allocation made by alignedAlloc. Uses realloc when possible
+	 * so that large blocks can be grown in place or remapped by the OS
+	 * instead of copied. */
+	static void* alignedRealloc(void* p, size_t old_size, size_t new_size, size_t alignment) {
+#ifdef _WIN32
+		(void) old_size;
+		return _aligned_realloc(p, new_size, alignment);
+#else
+		if (alignment <= alignof(std::max_align_t))
+			return std::realloc(p, new_size);
+
+		void* new_p = alignedAlloc(new_size, alignment);
+		if (new_p != nullptr && p != nullptr) {
+			std::memcpy(new_p, p, old_size);
+			std::free(p);
+		}
+		return new_p;
+#endif
+	}
+
+	static void alignedFree(void* p) {
+#ifdef _WIN32
+		_aligned_free(p);
+#else
+		std::free(p);
+#endif
+	}
+
+	DynamicPoolAllocator::DynamicPoolAllocator(size_t object_size, size_t alignment, PoolGrowth growth, size_t chunk_objects)
 		: object_size(object_size),
-		data_begin(nullptr), data_end(nullptr),
-		data_alloc_end(nullptr)
-	{}
+		stride((object_size + alignment - 1) / alignment * alignment),
+		alignment(alignment), growth(growth), chunk_shift(0),
+		count(0), capacity_count(0),
+		data_begin(nullptr)
+	{
+		assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+		assert(chunk_objects != 0 && (chunk_objects & (chunk_objects - 1)) == 0);
+		while ((size_t(1) << chunk_shift) < chunk_objects) {
+			++chunk_shift;
+		}
+	}
 
 	DynamicPoolAllocator::DynamicPoolAllocator(const DynamicPoolAllocator& o)
-		: object_size(o.object_size),
-		data_begin(nullptr), data_end(nullptr),
-		data_alloc_end(nullptr)
+		: object_size(o.object_size), stride(o.stride),
+		alignment(o.alignment), growth(o.growth), chunk_shift(o.chunk_shift),
+		count(0), capacity_count(0),
+		data_begin(nullptr)
 	{
 		*this = o;
 	}
 
 	DynamicPoolAllocator::~DynamicPoolAllocator() {
-		delete[] data_begin;
+		clear();
 	}
 
 	DynamicPoolAllocator& DynamicPoolAllocator::operator =(const DynamicPoolAllocator& o) {
-		delete[] data_begin;
-		data_begin = new uint8_t[o.data_alloc_end - o.data_begin];
-		data_end = data_begin + (o.data_end - o.data_begin);
-		data_alloc_end = data_begin + (o.data_alloc_end - o.data_begin);
-		std::memcpy(data_begin, o.data_begin, o.data_end - o.data_begin);
+		if (this == &o)
+			return *this;
+
+		clear();
+		object_size = o.object_size;
+		stride = o.stride;
+		alignment = o.alignment;
+		growth = o.growth;
+		chunk_shift = o.chunk_shift;
+
+		reserve(o.count);
+		if (growth == PoolGrowth::contiguous) {
+			if (o.count != 0) {
+				std::memcpy(data_begin, o.data_begin, o.count * stride);
+			}
+		} else {
+			const size_t chunk_objects = size_t(1) << chunk_shift;
+			for (size_t first = 0; first < o.count; first += chunk_objects) {
+				const size_t n = o.count - first < chunk_objects ? o.count - first : chunk_objects;
+				std::memcpy(chunks[first >> chunk_shift], o.chunks[first >> chunk_shift], n * stride);
+			}
+		}
+		count = o.count;
 
 		return *this;
 	}
@@ -37,82 +111,160 @@ namespace yks {
 	}
 
 	size_t DynamicPoolAllocator::size() const {
-		return (data_end - data_begin) / object_size;
+		return count;
 	}
 
 	size_t DynamicPoolAllocator::capacity() const {
-		return (data_alloc_end - data_begin) / object_size;
+		return capacity_count;
 	}
 
 	void DynamicPoolAllocator::reserve(size_t num) {
-		if (num * object_size < (size_t)(data_alloc_end - data_begin)) {
-			expand(num * object_size);
+		if (num > capacity_count) {
+			expand(num);
 		}
 	}
 
 	void* DynamicPoolAllocator::push_back() {
-		if (data_end == data_alloc_end) {
+		if (count == capacity_count) {
 			expand();
 		}
 
-		void* dst_ptr = data_end;
-		data_end += object_size;
+		void* dst_ptr = at(count++);
 		std::memset(dst_ptr, 0x55, object_size);
 		return dst_ptr;
 	}
 
 	void* DynamicPoolAllocator::push_back(const void* src_data) {
-		if (data_end == data_alloc_end) {
+		if (count == capacity_count) {
 			expand();
 		}
 
-		void* dst_ptr = data_end;
-		data_end += object_size;
+		void* dst_ptr = at(count++);
 		std::memcpy(dst_ptr, src_data, object_size);
 		return dst_ptr;
 	}
 
 	void DynamicPoolAllocator::pop_back() {
-		assert(data_end != data_begin);
-		data_end -= object_size;
+		assert(count != 0);
+		--count;
 	}
 
 	void DynamicPoolAllocator::copy(size_t from, size_t to) {
 		if (from != to) {
-			std::memcpy(data_begin + from * object_size, data_begin + to * object_size, object_size);
+			std::memcpy(at(to), at(from), object_size);
+		}
+	}
+
+	void* DynamicPoolAllocator::begin() {
+		assert(growth == PoolGrowth::contiguous);
+		return data_begin;
+	}
+
+	void* DynamicPoolAllocator::end() {
+		assert(growth == PoolGrowth::contiguous);
+		return data_begin + count * stride;
+	}
+
+	const void* DynamicPoolAllocator::begin() const {
+		assert(growth == PoolGrowth::contiguous);
+		return data_begin;
+	}
+
+	const void* DynamicPoolAllocator::end() const {
+		assert(growth == PoolGrowth::contiguous);
+		return data_begin + count * stride;
+	}
+
+	void DynamicPoolAllocator::copyTo(void* dst) const {
+		uint8_t* out = static_cast<uint8_t*>(dst);
+		for (size_t i = 0; i < count; ) {
+			const size_t n = contiguousCount(i);
+			std::memcpy(out + i * stride, at(i), n * stride);
+			i += n;
+		}
+	}
+
+	void DynamicPoolAllocator::assign(const void* src, size_t num) {
+		reserve(num);
+		count = num;
+
+		const uint8_t* in = static_cast<const uint8_t*>(src);
+		for (size_t i = 0; i < count; ) {
+			const size_t n = contiguousCount(i);
+			std::memcpy(at(i), in + i * stride, n * stride);
+			i += n;
+		}
+	}
+
+	size_t DynamicPoolAllocator::contiguousCount(size_t i) const {
+		assert(i <= count);
+		if (growth == PoolGrowth::contiguous) {
+			return count - i;
+		} else {
+			const size_t chunk_end = ((i >> chunk_shift) + 1) << chunk_shift;
+			return (chunk_end < count ? chunk_end : count) - i;
 		}
 	}
 
 	void* DynamicPoolAllocator::operator [](size_t i) {
-		uint8_t* p = data_begin + i*object_size;
-		assert(p < data_end);
-		return p;
+		assert(i < count);
+		return at(i);
 	}
 
 	const void* DynamicPoolAllocator::operator [](size_t i) const {
-		const uint8_t* p = data_begin + i*object_size;
-		assert(p < data_end);
-		return p;
+		assert(i < count);
+		return at(i);
+	}
+
+	uint8_t* DynamicPoolAllocator::at(size_t i) const {
+		if (growth == PoolGrowth::contiguous) {
+			return data_begin + i * stride;
+		} else {
+			const size_t chunk_mask = (size_t(1) << chunk_shift) - 1;
+			return chunks[i >> chunk_shift] + (i & chunk_mask) * stride;
+		}
+	}
+
+	void DynamicPoolAllocator::clear() {
+		alignedFree(data_begin);
+		data_begin = nullptr;
+		for (uint8_t* chunk : chunks) {
+			alignedFree(chunk);
+		}
+		chunks.clear();
+
+		count = 0;
+		capacity_count = 0;
 	}
 
-	void DynamicPoolAllocator::expand(size_t new_capacity_bytes) {
-		assert(new_capacity_bytes > (size_t)(data_alloc_end - data_begin));
-		uint8_t* new_begin = new uint8_t[new_capacity_bytes];
-		uint8_t* new_end = new_begin + (data_end - data_begin);
+	void DynamicPoolAllocator::expand(size_t new_capacity) {
+		assert(new_capacity > capacity_count);
 
-		std::memcpy(new_begin, data_begin, data_end - data_begin);
-		delete[] data_begin;
+		if (growth == PoolGrowth::contiguous) {
+			void* new_begin = alignedRealloc(data_begin, capacity_count * stride, new_capacity * stride, alignment);
+			assert(new_begin != nullptr); // TODO: ERROR_CHECK
 
-		data_begin = new_begin;
-		data_end = new_end;
-		data_alloc_end = new_begin + new_capacity_bytes;
+			data_begin = static_cast<uint8_t*>(new_begin);
+			capacity_count = new_capacity;
+		} else {
+			const size_t chunk_bytes = stride << chunk_shift;
+			while (capacity_count < new_capacity) {
+				void* chunk = alignedAlloc(chunk_bytes, alignment);
+				assert(chunk != nullptr); // TODO: ERROR_CHECK
+
+				chunks.push_back(static_cast<uint8_t*>(chunk));
+				capacity_count += size_t(1) << chunk_shift;
+			}
+		}
 	}
 
 	void DynamicPoolAllocator::expand() {
-		if (data_alloc_end == data_begin) {
-			expand(4 * object_size);
+		if (growth == PoolGrowth::chunked) {
+			expand(capacity_count + 1);
+		} else if (capacity_count == 0) {
+			expand(4);
 		} else {
-			expand((data_alloc_end - data_begin) * 2);
+			expand(capacity_count * 2);
 		}
 	}
 
@@ -1,16 +1,36 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 namespace yks {
 
+	enum class PoolGrowth {
+		/** Objects are kept in a single block, which is grown with realloc.
+		 * Growing may move every object. */
+		contiguous,
+		/** Objects are kept in fixed-size chunks which are never moved, so
+		 * growing doesn't move existing objects or copy them. */
+		chunked,
+	};
+
 	struct DynamicPoolAllocator {
-		DynamicPoolAllocator(size_t object_size);
+		/** object_size is padded up to a multiple of alignment to get the
+		 * stride between objects. By default objects are packed with no
+		 * padding, callers that need aligned objects ask for it. chunk_objects
+		 * is the number of objects per chunk in chunked mode, and must be a
+		 * power of two. */
+		DynamicPoolAllocator(size_t object_size, size_t alignment = 1,
+			PoolGrowth growth = PoolGrowth::contiguous, size_t chunk_objects = 1024);
 		DynamicPoolAllocator(const DynamicPoolAllocator& o);
 		~DynamicPoolAllocator();
 		DynamicPoolAllocator& operator =(const DynamicPoolAllocator& o);
 
 		size_t getObjectSize() const;
+		size_t getStride() const { return stride; }
+		size_t getAlignment() const { return alignment; }
+		PoolGrowth getGrowth() const { return growth; }
 
 		size_t size() const;
 		size_t capacity() const;
@@ -21,21 +41,40 @@ namespace yks {
 		void pop_back();
 		void copy(size_t from, size_t to);
 
-		void* begin() { return data_begin; }
-		void* end() { return data_end; }
-		const void* begin() const { return data_begin; }
-		const void* end() const { return data_end; }
+		// Only available in contiguous mode.
+		void* begin();
+		void* end();
+		const void* begin() const;
+		const void* end() const;
+
+		/** Copies all objects to dst, which must have room for size() *
+		 * getStride() bytes. */
+		void copyTo(void* dst) const;
+		/** Replaces the contents with count objects from src, laid out with
+		 * getStride() stride. */
+		void assign(const void* src, size_t count);
+
+		/** Number of objects stored contiguously in memory starting at i. */
+		size_t contiguousCount(size_t i) const;
 
 		void* operator [](size_t i);
 		const void* operator [](size_t i) const;
 
 	private:
 		size_t object_size;
-		uint8_t* data_begin;
-		uint8_t* data_end;
-		uint8_t* data_alloc_end;
+		size_t stride;
+		size_t alignment;
+		PoolGrowth growth;
+		size_t chunk_shift; // log2 of objects per chunk
+
+		size_t count;
+		size_t capacity_count;
+		uint8_t* data_begin; // Contiguous mode
+		std::vector<uint8_t*> chunks; // Chunked mode
 
-		void expand(size_t new_capacity_bytes);
+		uint8_t* at(size_t i) const;
+		void clear();
+		void expand(size_t new_capacity);
 		void expand();
 	};
 
@@ -0,0 +1,80 @@
+#include "FrameArena.hpp"
+#include <cassert>
+#include <cstdlib>
+
+namespace yks {
+
+	static size_t alignUp(size_t x, size_t alignment) {
+		return (x + alignment - 1) & ~(alignment - 1);
+	}
+
+	FrameArena::FrameArena(size_t initial_capacity)
+		: block(static_cast<uint8_t*>(std::malloc(initial_capacity))),
+		capacity(initial_capacity), offset(0),
+		overflow_bytes(0), high_water_mark(0)
+	{
+		assert(block != nullptr || initial_capacity == 0); // TODO: ERROR_CHECK
+		overflow_blocks.reserve(16);
+	}
+
+	FrameArena::~FrameArena() {
+		freeOverflowBlocks();
+		std::free(block);
+	}
+
+	void* FrameArena::allocate(size_t size, size_t alignment) {
+		assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+		// Align the address rather than the offset, since the block is only
+		// aligned to max_align_t.
+		const uintptr_t base = reinterpret_cast<uintptr_t>(block);
+		const size_t start = alignUp(base + offset, alignment) - base;
+		if (start + size <= capacity) {
+			offset = start + size;
+			if (getUsed() > high_water_mark) {
+				high_water_mark = getUsed();
+			}
+			return block + start;
+		}
+
+		// Doesn't fit, so give it its own block until the next reset
+		const size_t overflow_size = size + alignment;
+		void* overflow = std::malloc(overflow_size);
+		assert(overflow != nullptr); // TODO: ERROR_CHECK
+		overflow_blocks.push_back(overflow);
+		overflow_bytes += overflow_size;
+		if (getUsed() > high_water_mark) {
+			high_water_mark = getUsed();
+		}
+
+		const uintptr_t overflow_base = reinterpret_cast<uintptr_t>(overflow);
+		return reinterpret_cast<void*>(alignUp(overflow_base, alignment));
+	}
+
+	void FrameArena::reset() {
+		if (!overflow_blocks.empty()) {
+			freeOverflowBlocks();
+
+			// Grow so everything the last frame needed fits in the main block
+			size_t new_capacity = capacity != 0 ? capacity : 1024;
+			while (new_capacity < high_water_mark) {
+				new_capacity *= 2;
+			}
+			std::free(block);
+			block = static_cast<uint8_t*>(std::malloc(new_capacity));
+			assert(block != nullptr); // TODO: ERROR_CHECK
+			capacity = new_capacity;
+		}
+
+		offset = 0;
+	}
+
+	void FrameArena::freeOverflowBlocks() {
+		for (void* p : overflow_blocks) {
+			std::free(p);
+		}
+		overflow_blocks.clear();
+		overflow_bytes = 0;
+	}
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "noncopyable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yks {
+
+	/** Bump-pointer allocator for data which only lives until the end of a
+	 * frame. Allocating is a pointer increment and freeing is done all at
+	 * once by reset().
+	 *
+	 * Allocations that don't fit get their own heap block. On reset the main
+	 * block is grown to the high-water mark, so after a few frames a steady
+	 * workload doesn't touch the heap at all. */
+	struct FrameArena {
+		explicit FrameArena(size_t initial_capacity = 64 * 1024);
+		~FrameArena();
+
+		void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		template <typename T>
+		T* allocateArray(size_t count) {
+			return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+		}
+
+		/** Frees all allocations. */
+		void reset();
+
+		/** Bytes allocated since the last reset, including padding. */
+		size_t getUsed() const { return offset + overflow_bytes; }
+		size_t getCapacity() const { return capacity; }
+		/** Largest getUsed() seen at any point. */
+		size_t getHighWaterMark() const { return high_water_mark; }
+		/** Allocations since the last reset that didn't fit the main block. */
+		size_t getNumOverflows() const { return overflow_blocks.size(); }
+
+	private:
+		uint8_t* block;
+		size_t capacity;
+		size_t offset;
+
+		std::vector<void*> overflow_blocks;
+		size_t overflow_bytes;
+		size_t high_water_mark;
+
+		void freeOverflowBlocks();
+
+		NONCOPYABLE(FrameArena);
+	};
+
+	/** Pair of arenas which alternate every frame, so that data allocated
+	 * during one frame is still valid during the next. */
+	struct DoubleBufferedArena {
+		explicit DoubleBufferedArena(size_t initial_capacity = 64 * 1024)
+			: arena_a(initial_capacity), arena_b(initial_capacity)
+		{}
+
+		FrameArena& current() { return a_is_current ? arena_a : arena_b; }
+		FrameArena& previous() { return a_is_current ? arena_b : arena_a; }
+
+		/** Switches arenas, freeing everything allocated two frames ago. */
+		void nextFrame() {
+			a_is_current = !a_is_current;
+			current().reset();
+		}
+
+		size_t getHighWaterMark() const {
+			const size_t a = arena_a.getHighWaterMark();
+			const size_t b = arena_b.getHighWaterMark();
+			return a > b ? a : b;
+		}
+
+	private:
+		FrameArena arena_a;
+		FrameArena arena_b;
+		bool a_is_current = true;
+	};
+
+	/** Allocator using a FrameArena, for std containers that only live until
+	 * the arena is reset. Deallocation does nothing. */
+	template <typename T>
+	struct ArenaAllocator {
+		typedef T value_type;
+
+		FrameArena* arena;
+
+		explicit ArenaAllocator(FrameArena& arena)
+			: arena(&arena)
+		{}
+
+		template <typename U>
+		ArenaAllocator(const ArenaAllocator<U>& o)
+			: arena(o.arena)
+		{}
+
+		T* allocate(size_t n) {
+			return arena->allocateArray<T>(n);
+		}
+
+		void deallocate(T*, size_t) {}
+
+		template <typename U>
+		bool operator ==(const ArenaAllocator<U>& o) const {
+			return arena == o.arena;
+		}
+
+		template <typename U>
+		bool operator !=(const ArenaAllocator<U>& o) const {
+			return arena != o.arena;
+		}
+	};
+
+}
@@ -1,74 +1,180 @@
 #pragma once
 #include "Handle.hpp"
+#include "Span.hpp"
+#include "PoolRoster.hpp"
+#include "PoolStats.hpp"
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <climits>
 #include <cstddef>
 #include <vector>
 
 namespace yks {
 
-	/** Manages a pool of objects, providing persistent handles to them. */
-	template <typename T>
-	struct ObjectPool {
-		size_t first_free_index; // in roster
-	
-		// For used entries: .index is index into pool.
-		// For free entries: .index is index of next free entry.
-		std::vector<Handle> roster;
+	/** Manages a pool of objects, providing persistent handles to them.
+	 * H is Handle or a PackedHandle, which limits how many objects the pool
+	 * can hold. */
+	template <typename T, typename H = Handle>
+	struct ObjectPool : private PoolStatsTracker, public PoolRoster<H> {
+		using PoolRoster<H>::roster;
+		using PoolRoster<H>::pool_indices;
+		using PoolRoster<H>::isValid;
 
 		std::vector<T> pool;
-		std::vector<size_t> pool_indices;
 
-		ObjectPool()
-			: first_free_index(SIZE_MAX)
-		{}
+		// Progress of sortIncremental
+		size_t sort_cursor = 1;
+		bool sort_pass_clean = false;
 
 		template <typename... Args>
-		Handle emplace(Args&&... params) {
-			// Expand roster if we're out of entries
-			if (first_free_index >= roster.size()) {
-				expand_roster();
+		H emplace(Args&&... params) {
+			this->trackGrowth(pool.size() == pool.capacity(), [&] {
+				pool.emplace_back(std::forward<Args>(params)...);
+			});
+			return bindNewObject();
+		}
+
+		/** Inserts copies of objects, writing their handles to out_handles,
+		 * which must have room for objects.size() handles. */
+		void insertBulk(Span<const T> objects, H* out_handles) {
+			reserveFor(objects.size());
+			for (size_t i = 0; i < objects.size(); ++i) {
+				pool.push_back(objects[i]);
+				out_handles[i] = bindNewObject();
+			}
+		}
+
+		/** Inserts count objects all constructed from params, writing their
+		 * handles to out_handles. */
+		template <typename... Args>
+		void emplaceBulk(size_t count, H* out_handles, const Args&... params) {
+			reserveFor(count);
+			for (size_t i = 0; i < count; ++i) {
+				pool.emplace_back(params...);
+				out_handles[i] = bindNewObject();
+			}
+		}
+
+		void remove(const H h) {
+			if (this->unbind(h, [this](size_t from, size_t to) { pool[to] = std::move(pool[from]); })) {
+				pool.pop_back();
+				// Moves an object out of order
+				sort_pass_clean = false;
 			}
+		}
 
-			// Pop head off of free list
-			const size_t roster_index = first_free_index;
-			first_free_index = roster[roster_index].index;
+		/** All objects in the pool, densely packed. In no particular order,
+		 * unless sorted with sortBy or sortIncremental. */
+		Span<T> objects() { return pool; }
+		Span<const T> objects() const { return pool; }
 
-			// Point roster entry to right place and insert object
-			roster[roster_index].index = pool.size();
-			pool.emplace_back(std::forward<Args>(params)...);
-			pool_indices.push_back(roster_index);
+		size_t size() const { return pool.size(); }
 
-			return Handle(roster_index, roster[roster_index].generation);
+		/** Reorders objects so that key(object) is ascending, keeping handles
+		 * valid. Objects with equal keys keep their relative order. */
+		template <typename KeyFn>
+		void sortBy(KeyFn key) {
+			std::vector<size_t> order(pool.size());
+			for (size_t i = 0; i < order.size(); ++i) {
+				order[i] = i;
+			}
+			std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+				return key(pool[a]) < key(pool[b]);
+			});
+
+			std::vector<T> sorted_pool;
+			std::vector<typename H::index_type> sorted_indices;
+			sorted_pool.reserve(pool.size());
+			sorted_indices.reserve(pool.size());
+			for (size_t i : order) {
+				roster[pool_indices[i]].index = sorted_pool.size();
+				sorted_pool.push_back(std::move(pool[i]));
+				sorted_indices.push_back(pool_indices[i]);
+			}
+			pool.swap(sorted_pool);
+			pool_indices.swap(sorted_indices);
+
+			sort_cursor = pool.size();
+			sort_pass_clean = true;
 		}
 
-		void remove(const Handle h) {
-			if (!isValid(h))
-				return;
-
-			// Indices for object being removed
-			const size_t roster_index = h.index;
-			const size_t pool_index = roster[roster_index].index;
-
-			// Indices for object being moved into its place
-			const size_t moved_roster_index = pool_indices.back();
-			const size_t moved_pool_index = pool.size() - 1;
-			assert(roster[moved_roster_index].index == moved_pool_index);
-
-			// Move last element in place of the removed one, updating roster
-			roster[moved_roster_index].index = pool_index;
-			pool[pool_index] = std::move(pool[moved_pool_index]);
-			pool.pop_back();
-			pool_indices[pool_index] = pool_indices[moved_pool_index];
-			pool_indices.pop_back();
-
-			// Increment generation of removed roster entry and add it to free list
-			++roster[roster_index].generation;
-			roster[roster_index].index = first_free_index;
-			first_free_index = roster_index;
+		/** Does part of an insertion sort by key(object), keeping handles
+		 * valid, stopping once budget has been spent. Progress is kept between
+		 * calls, and objects added or removed meanwhile get sorted in later
+		 * calls. Returns true once a whole pass finds everything in order.
+		 *
+		 * Insertion sort is slow in general, but cheap when only a few
+		 * objects are out of place, which is the case when called regularly
+		 * on a pool with moderate churn. Use sortBy to sort a scrambled pool. */
+		template <typename KeyFn>
+		bool sortIncremental(KeyFn key, std::chrono::steady_clock::duration budget) {
+			const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + budget;
+			static const size_t moves_per_clock_check = 256;
+			size_t moves_since_check = 0;
+			const auto outOfTime = [&] {
+				if (++moves_since_check < moves_per_clock_check)
+					return false;
+				moves_since_check = 0;
+				return std::chrono::steady_clock::now() >= deadline;
+			};
+
+			for (;;) {
+				if (sort_cursor >= pool.size()) {
+					// Start a new pass, unless the last one found nothing to do
+					const bool was_clean = sort_pass_clean;
+					sort_cursor = 1;
+					sort_pass_clean = true;
+					if (was_clean || pool.size() <= 1)
+						return true;
+				}
+
+				// Sink the object at the cursor into the sorted part
+				size_t i = sort_cursor++;
+				if (!(key(pool[i]) < key(pool[i - 1]))) {
+					if (outOfTime())
+						return false;
+				} else {
+					sort_pass_clean = false;
+					T moved = std::move(pool[i]);
+					const typename H::index_type moved_roster_index = pool_indices[i];
+					const auto moved_key = key(moved);
+					bool stopped = false;
+					do {
+						pool[i] = std::move(pool[i - 1]);
+						pool_indices[i] = pool_indices[i - 1];
+						roster[pool_indices[i]].index = i;
+						--i;
+						stopped = outOfTime();
+					} while (!stopped && i > 0 && moved_key < key(pool[i - 1]));
+					pool[i] = std::move(moved);
+					pool_indices[i] = moved_roster_index;
+					roster[moved_roster_index].index = i;
+
+					if (stopped) {
+						// A long sink can take O(n) moves, so it's interrupted
+						// too. The objects it passed are still in order, so
+						// the next call resumes sinking from where it stopped.
+						sort_cursor = std::max<size_t>(i, 1);
+						return false;
+					}
+				}
+			}
 		}
 
-		T* operator[] (const Handle h) {
+		PoolStats getStats() const {
+			PoolStats stats;
+			stats.object_size = sizeof(T);
+			stats.live = pool.size();
+			stats.roster_size = roster.size();
+			stats.capacity = pool.capacity();
+			stats.free_list_length = roster.size() - pool.size();
+			stats.slack_bytes = (pool.capacity() - pool.size()) * sizeof(T) + this->getRosterSlackBytes();
+			this->fillTrackedStats(stats);
+			return stats;
+		}
+
+		T* operator[] (const H h) {
 			if (isValid(h)) {
 				assert(roster[h.index].index < pool.size());
 				return &pool[roster[h.index].index];
@@ -77,7 +183,7 @@ namespace yks {
 			}
 		}
 
-		const T* operator[] (const Handle h) const {
+		const T* operator[] (const H h) const {
 			if (isValid(h)) {
 				assert(roster[h.index].index < pool.size());
 				return &pool[roster[h.index].index];
@@ -86,36 +192,18 @@ namespace yks {
 			}
 		}
 
-		/** Checks if object referenced by handle is still in the pool. */
-		bool isValid(const Handle h) const {
-			return h.index < roster.size() && roster[h.index].generation == h.generation;
-		}
-
-		/** Creates a handle to the object currently at pool[index]. */
-		Handle makeHandle(size_t index) const {
-			if (index >= pool.size())
-				return Handle();
-			else
-				return Handle(index, roster[pool_indices[index]].generation);
-		}
-
-		/** Get index into pool for handle. */
-		size_t getPoolIndex(const Handle h) const {
-			if (isValid(h)) {
-				return roster[h.index].index;
-			} else {
-				return SIZE_MAX;
-			}
-		}
-
 	private:
-		void expand_roster() {
-			const Handle new_entry(first_free_index, 0);
-
-			first_free_index = roster.size();
-			roster.push_back(new_entry);
+		H bindNewObject() {
+			const H h = PoolRoster<H>::bindNewObject();
+			this->trackSize(pool.size(), roster.size());
+			return h;
+		}
 
-			assert(first_free_index < roster.size());
+		void reserveFor(size_t count) {
+			this->trackGrowth(pool.size() + count > pool.capacity(), [&] {
+				pool.reserve(pool.size() + count);
+			});
+			this->reserveEntries(count);
 		}
 	};
 
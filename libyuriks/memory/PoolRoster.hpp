@@ -0,0 +1,156 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yks {
+
+	/** Handle bookkeeping shared by the object pools. Pools keep their
+	 * objects densely packed and tell the roster which pool index each new
+	 * object went to. When objects are removed, the roster tells the pool
+	 * which objects to move to fill the holes, through a move(from, to)
+	 * callback, after which the pool shrinks its storage to size(). */
+	template <typename H>
+	struct PoolRoster {
+		size_t first_free_index = H::null_index; // in roster
+
+		// For used entries: .index is index into pool.
+		// For free entries: .index is index of next free entry.
+		std::vector<H> roster;
+
+		// Roster index of each object in the pool
+		std::vector<typename H::index_type> pool_indices;
+
+		size_t size() const { return pool_indices.size(); }
+
+		/** Checks if object referenced by handle is still in the pool. */
+		bool isValid(const H h) const {
+			return h.index < roster.size() && roster[h.index].generation == h.generation;
+		}
+
+		/** Creates a handle to the object currently at pool[index]. */
+		H makeHandle(size_t index) const {
+			if (index >= size())
+				return H();
+			else
+				return H(pool_indices[index], roster[pool_indices[index]].generation);
+		}
+
+		/** Get index into pool for handle. */
+		size_t getPoolIndex(const H h) const {
+			if (isValid(h)) {
+				return roster[h.index].index;
+			} else {
+				return SIZE_MAX;
+			}
+		}
+
+	protected:
+		/** Makes room for count more objects without reallocating. */
+		void reserveEntries(size_t count) {
+			pool_indices.reserve(size() + count);
+			roster.reserve(size() + count);
+		}
+
+		/** Assigns a roster entry to the object just added to the back of the
+		 * pool, at index size(). */
+		H bindNewObject() {
+			// Expand roster if we're out of entries
+			if (first_free_index >= roster.size()) {
+				expand_roster();
+			}
+
+			// Pop head off of free list
+			const size_t roster_index = first_free_index;
+			first_free_index = roster[roster_index].index;
+
+			// Point roster entry to right place
+			roster[roster_index].index = size();
+			pool_indices.push_back(static_cast<typename H::index_type>(roster_index));
+
+			return H(roster_index, roster[roster_index].generation);
+		}
+
+		/** Frees the entry of h, moving the last object in its place. Returns
+		 * false without doing anything if h isn't valid. */
+		template <typename MoveFn>
+		bool unbind(const H h, MoveFn&& move) {
+			if (!isValid(h))
+				return false;
+
+			// Indices for object being removed
+			const size_t roster_index = h.index;
+			const size_t pool_index = roster[roster_index].index;
+
+			// Indices for object being moved into its place
+			const size_t moved_roster_index = pool_indices.back();
+			const size_t moved_pool_index = size() - 1;
+			assert(roster[moved_roster_index].index == moved_pool_index);
+
+			// Move last element in place of the removed one, updating roster
+			if (pool_index != moved_pool_index) {
+				roster[moved_roster_index].index = pool_index;
+				move(moved_pool_index, pool_index);
+				pool_indices[pool_index] = pool_indices[moved_pool_index];
+			}
+			pool_indices.pop_back();
+
+			freeEntry(roster_index);
+			return true;
+		}
+
+		/** Checks that a roster and pool indices from outside, such as a
+		 * snapshot, are consistent: every object has exactly one used entry
+		 * pointing back at it, and the free list links every other entry
+		 * once, without leaving the roster. */
+		static bool isConsistent(size_t first_free_index, const std::vector<H>& roster,
+			const std::vector<typename H::index_type>& pool_indices)
+		{
+			if (pool_indices.size() > roster.size())
+				return false;
+
+			std::vector<bool> seen(roster.size(), false);
+			for (size_t i = 0; i < pool_indices.size(); ++i) {
+				const size_t roster_index = pool_indices[i];
+				if (roster_index >= roster.size() || seen[roster_index] || roster[roster_index].index != i)
+					return false;
+				seen[roster_index] = true;
+			}
+
+			size_t num_free = 0;
+			for (size_t i = first_free_index; i != H::null_index; i = roster[i].index) {
+				if (i >= roster.size() || seen[i])
+					return false;
+				seen[i] = true;
+				++num_free;
+			}
+			return pool_indices.size() + num_free == roster.size();
+		}
+
+		/** Unused capacity of the roster arrays, in bytes. */
+		size_t getRosterSlackBytes() const {
+			return (pool_indices.capacity() - pool_indices.size()) * sizeof(typename H::index_type) +
+				(roster.capacity() - roster.size()) * sizeof(H);
+		}
+
+	private:
+		/** Increments the generation of a removed entry and adds it to the free list. */
+		void freeEntry(size_t roster_index) {
+			++roster[roster_index].generation;
+			roster[roster_index].index = first_free_index;
+			first_free_index = roster_index;
+		}
+
+		void expand_roster() {
+			assert(roster.size() < H::null_index); // TODO: ERROR_CHECK
+			const H new_entry(first_free_index, 0);
+
+			first_free_index = roster.size();
+			roster.push_back(new_entry);
+
+			assert(first_free_index < roster.size());
+		}
+	};
+
+}
@@ -0,0 +1,22 @@
+#include "PoolStats.hpp"
+#include <cstdio>
+#include <ostream>
+
+namespace yks {
+
+	void printPoolStatsHeader(std::ostream& out) {
+		char line[256];
+		std::snprintf(line, sizeof(line), "%-24s %10s %10s %10s %10s %10s %10s %10s %8s %10s %10s",
+			"pool", "live", "peak", "roster", "free", "capacity", "slack KiB", "peak rost", "growths", "grow ms", "max ms");
+		out << line << '\n';
+	}
+
+	void printPoolStats(std::ostream& out, const char* name, const PoolStats& stats) {
+		char line[256];
+		std::snprintf(line, sizeof(line), "%-24s %10zu %10zu %10zu %10zu %10zu %10.1f %10zu %8zu %10.3f %10.3f",
+			name, stats.live, stats.peak_live, stats.roster_size, stats.free_list_length, stats.capacity,
+			stats.slack_bytes / 1024.0, stats.peak_roster_size, stats.num_growths, stats.growth_seconds * 1e3, stats.max_growth_seconds * 1e3);
+		out << line << '\n';
+	}
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <iosfwd>
+
+// Define YKS_POOL_STATS to 1 to track peaks and growth events in object
+// pools. When disabled, pools only report what they can compute on demand
+// and the tracking compiles away entirely.
+#ifndef YKS_POOL_STATS
+#define YKS_POOL_STATS 0
+#endif
+
+#if YKS_POOL_STATS
+#include <chrono>
+#endif
+
+namespace yks {
+
+	struct PoolStats {
+		size_t object_size = 0;
+		size_t live = 0; // Objects in the pool
+		size_t roster_size = 0; // Handles ever allocated
+		size_t capacity = 0; // Objects that fit without growing
+		size_t free_list_length = 0; // Roster entries waiting to be reused
+		size_t slack_bytes = 0; // Allocated but unused, in all pool arrays
+
+		// Only tracked with YKS_POOL_STATS
+		size_t peak_live = 0;
+		size_t peak_roster_size = 0;
+		size_t num_growths = 0;
+		double growth_seconds = 0.0; // Total spent growing
+		double max_growth_seconds = 0.0;
+	};
+
+	void printPoolStatsHeader(std::ostream& out);
+	/** Prints stats as a row of the table started by printPoolStatsHeader. */
+	void printPoolStats(std::ostream& out, const char* name, const PoolStats& stats);
+
+#if YKS_POOL_STATS
+	/** Base of pool classes tracking stats that can't be computed later. */
+	struct PoolStatsTracker {
+		void trackSize(size_t live, size_t roster_size) {
+			if (live > peak_live) peak_live = live;
+			if (roster_size > peak_roster_size) peak_roster_size = roster_size;
+		}
+
+		/** Runs f, timing it as a growth event if will_grow is set. */
+		template <typename F>
+		void trackGrowth(bool will_grow, F&& f) {
+			if (!will_grow) {
+				f();
+				return;
+			}
+
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			f();
+			const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			num_growths += 1;
+			growth_seconds += t;
+			if (t > max_growth_seconds) max_growth_seconds = t;
+		}
+
+		void fillTrackedStats(PoolStats& stats) const {
+			stats.peak_live = peak_live;
+			stats.peak_roster_size = peak_roster_size;
+			stats.num_growths = num_growths;
+			stats.growth_seconds = growth_seconds;
+			stats.max_growth_seconds = max_growth_seconds;
+		}
+
+	private:
+		size_t peak_live = 0;
+		size_t peak_roster_size = 0;
+		size_t num_growths = 0;
+		double growth_seconds = 0.0;
+		double max_growth_seconds = 0.0;
+	};
+#else
+	struct PoolStatsTracker {
+		void trackSize(size_t, size_t) {}
+
+		template <typename F>
+		void trackGrowth(bool, F&& f) { f(); }
+
+		void fillTrackedStats(PoolStats&) const {}
+	};
+#endif
+
+}
@@ -0,0 +1,132 @@
+#include "SnapshotDelta.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace yks {
+
+	namespace {
+		// Granularity of comparisons. Smaller blocks make smaller deltas, but
+		// more and shorter runs.
+		const size_t block_size = 64;
+
+		struct DeltaHeader {
+			uint64_t base_size;
+			uint64_t target_size;
+		};
+
+		struct RunHeader {
+			uint64_t offset;
+			uint64_t length;
+		};
+	}
+
+	size_t getMaxSnapshotDeltaSize(size_t target_size) {
+		// Runs are separated by at least one unchanged block, so there are
+		// at most half as many runs as blocks, plus the tail.
+		const size_t num_blocks = (target_size + block_size - 1) / block_size;
+		return sizeof(DeltaHeader) + target_size + (num_blocks / 2 + 2) * sizeof(RunHeader);
+	}
+
+	size_t diffSnapshots(const void* base, size_t base_size, const void* target, size_t target_size,
+		void* delta, size_t delta_capacity)
+	{
+		const uint8_t* a = static_cast<const uint8_t*>(base);
+		const uint8_t* b = static_cast<const uint8_t*>(target);
+		uint8_t* out = static_cast<uint8_t*>(delta);
+		uint8_t* const out_end = out + delta_capacity;
+
+		if (delta_capacity < sizeof(DeltaHeader))
+			return 0;
+		const DeltaHeader header = { base_size, target_size };
+		std::memcpy(out, &header, sizeof(header));
+		out += sizeof(header);
+
+		// Bytes past the end of base always count as changed
+		const size_t common_size = base_size < target_size ? base_size : target_size;
+
+		size_t pos = 0;
+		while (pos < target_size) {
+			// Skip unchanged blocks
+			while (pos < common_size) {
+				const size_t n = common_size - pos < block_size ? common_size - pos : block_size;
+				if (std::memcmp(a + pos, b + pos, n) != 0)
+					break;
+				pos += n;
+			}
+			if (pos >= target_size)
+				break;
+
+			// Extend the run over changed blocks
+			size_t end = pos;
+			while (end < target_size) {
+				const size_t n = target_size - end < block_size ? target_size - end : block_size;
+				if (end + n <= common_size && std::memcmp(a + end, b + end, n) == 0)
+					break;
+				end += n;
+			}
+
+			const RunHeader run = { pos, end - pos };
+			if (size_t(out_end - out) < sizeof(run) + (end - pos))
+				return 0;
+			std::memcpy(out, &run, sizeof(run));
+			out += sizeof(run);
+			std::memcpy(out, b + pos, end - pos);
+			out += end - pos;
+
+			pos = end;
+		}
+
+		return out - static_cast<uint8_t*>(delta);
+	}
+
+	size_t getSnapshotDeltaTargetSize(const void* delta, size_t delta_size) {
+		if (delta_size < sizeof(DeltaHeader))
+			return 0;
+
+		DeltaHeader header;
+		std::memcpy(&header, delta, sizeof(header));
+		return static_cast<size_t>(header.target_size);
+	}
+
+	size_t applySnapshotDelta(const void* base, size_t base_size, const void* delta, size_t delta_size,
+		void* out, size_t out_capacity)
+	{
+		const uint8_t* in = static_cast<const uint8_t*>(delta);
+		const uint8_t* const in_end = in + delta_size;
+
+		if (delta_size < sizeof(DeltaHeader))
+			return 0;
+		DeltaHeader header;
+		std::memcpy(&header, in, sizeof(header));
+		in += sizeof(header);
+
+		if (header.base_size != base_size || header.target_size > out_capacity)
+			return 0;
+		const size_t target_size = static_cast<size_t>(header.target_size);
+
+		// Start from base, unless applying in place
+		uint8_t* dst = static_cast<uint8_t*>(out);
+		if (out != base) {
+			std::memcpy(dst, base, base_size < target_size ? base_size : target_size);
+		}
+
+		while (in < in_end) {
+			RunHeader run;
+			if (size_t(in_end - in) < sizeof(run))
+				return 0;
+			std::memcpy(&run, in, sizeof(run));
+			in += sizeof(run);
+
+			if (run.offset > target_size || run.length > target_size - run.offset ||
+				run.length > size_t(in_end - in))
+			{
+				return 0;
+			}
+			std::memcpy(dst + run.offset, in, static_cast<size_t>(run.length));
+			in += run.length;
+		}
+
+		return target_size;
+	}
+
+}
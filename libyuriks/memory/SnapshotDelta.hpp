@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+
+namespace yks {
+
+	/** Largest delta diffSnapshots can produce for a target of target_size bytes. */
+	size_t getMaxSnapshotDeltaSize(size_t target_size);
+
+	/** Writes the changes needed to turn base into target to delta, as runs
+	 * of changed bytes. Works on any pair of byte buffers, such as two pool
+	 * snapshots. Returns the size of the delta, or 0 if delta_capacity is too
+	 * small (getMaxSnapshotDeltaSize() is always enough). */
+	size_t diffSnapshots(const void* base, size_t base_size, const void* target, size_t target_size,
+		void* delta, size_t delta_capacity);
+
+	/** Size of the target a delta was made from. */
+	size_t getSnapshotDeltaTargetSize(const void* delta, size_t delta_size);
+
+	/** Rebuilds the target of a delta in out, from the base it was diffed
+	 * against. out may be the same buffer as base, in which case only the
+	 * changed bytes are written. Returns the target size, or 0 if out_capacity
+	 * is too small or the delta is malformed. */
+	size_t applySnapshotDelta(const void* base, size_t base_size, const void* delta, size_t delta_size,
+		void* out, size_t out_capacity);
+
+}
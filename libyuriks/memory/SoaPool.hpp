@@ -0,0 +1,122 @@
+#pragma once
+#include "Handle.hpp"
+#include "Span.hpp"
+#include "PoolRoster.hpp"
+#include "PoolStats.hpp"
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace yks {
+
+	/** Manages a pool of objects made of Fields, providing persistent handles
+	 * to them. Works like ObjectPool, except each field is kept in its own
+	 * dense array so that code only using some fields doesn't have to load
+	 * the others. All arrays are in the same order, so the i-th element of
+	 * each field belongs to the same object. */
+	template <typename H, typename... Fields>
+	struct BasicSoaPool : private PoolStatsTracker, public PoolRoster<H> {
+		static_assert(sizeof...(Fields) > 0, "SoaPool needs at least one field");
+
+		using PoolRoster<H>::roster;
+		using PoolRoster<H>::isValid;
+		using PoolRoster<H>::size;
+
+		std::tuple<std::vector<Fields>...> fields;
+
+		template <size_t I>
+		using FieldType = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+
+		H insert(Fields... values) {
+			// All fields grow together, so the first one tells for all
+			this->trackGrowth(size() == std::get<0>(fields).capacity(), [&] {
+				insertFields(std::index_sequence_for<Fields...>(), std::move(values)...);
+			});
+			const H h = this->bindNewObject();
+			this->trackSize(size(), roster.size());
+			return h;
+		}
+
+		void remove(const H h) {
+			if (this->unbind(h, [this](size_t from, size_t to) {
+				moveFields(std::index_sequence_for<Fields...>(), from, to);
+			})) {
+				popFields(std::index_sequence_for<Fields...>());
+			}
+		}
+
+		void reserve(size_t count) {
+			this->trackGrowth(count > std::get<0>(fields).capacity(), [&] {
+				reserveFields(std::index_sequence_for<Fields...>(), count);
+			});
+			if (count > size()) {
+				this->reserveEntries(count - size());
+			}
+		}
+
+		/** Dense array of field I of all objects. */
+		template <size_t I>
+		Span<FieldType<I>> field() { return std::get<I>(fields); }
+		template <size_t I>
+		Span<const FieldType<I>> field() const { return std::get<I>(fields); }
+
+		/** Field I of the object referenced by h, or nullptr if it's invalid. */
+		template <size_t I>
+		FieldType<I>* get(const H h) {
+			if (!isValid(h))
+				return nullptr;
+			return &std::get<I>(fields)[roster[h.index].index];
+		}
+
+		template <size_t I>
+		const FieldType<I>* get(const H h) const {
+			if (!isValid(h))
+				return nullptr;
+			return &std::get<I>(fields)[roster[h.index].index];
+		}
+
+		/** object_size is the sum of the field sizes. */
+		PoolStats getStats() const {
+			PoolStats stats;
+			stats.object_size = (sizeof(Fields) + ...);
+			stats.live = size();
+			stats.roster_size = roster.size();
+			stats.capacity = std::get<0>(fields).capacity();
+			stats.free_list_length = roster.size() - size();
+			stats.slack_bytes = getFieldSlackBytes(std::index_sequence_for<Fields...>()) + this->getRosterSlackBytes();
+			this->fillTrackedStats(stats);
+			return stats;
+		}
+
+	private:
+		template <size_t... I>
+		void insertFields(std::index_sequence<I...>, Fields&&... values) {
+			(std::get<I>(fields).push_back(std::move(values)), ...);
+		}
+
+		template <size_t... I>
+		void moveFields(std::index_sequence<I...>, size_t from, size_t to) {
+			((std::get<I>(fields)[to] = std::move(std::get<I>(fields)[from])), ...);
+		}
+
+		template <size_t... I>
+		void popFields(std::index_sequence<I...>) {
+			(std::get<I>(fields).pop_back(), ...);
+		}
+
+		template <size_t... I>
+		void reserveFields(std::index_sequence<I...>, size_t count) {
+			(std::get<I>(fields).reserve(count), ...);
+		}
+
+		template <size_t... I>
+		size_t getFieldSlackBytes(std::index_sequence<I...>) const {
+			return (((std::get<I>(fields).capacity() - std::get<I>(fields).size()) * sizeof(FieldType<I>)) + ...);
+		}
+	};
+
+	template <typename... Fields>
+	using SoaPool = BasicSoaPool<Handle, Fields...>;
+
+}
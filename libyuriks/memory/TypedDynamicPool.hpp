@@ -1,37 +1,65 @@
 #pragma once
 #include "DynamicPool.hpp"
+#include <new>
 #include <type_traits>
 
 namespace yks {
 
 	/** Manages a pool of objects, providing persistent handles to them. */
-	template <typename T>
-	struct TypedDynamicPool : DynamicPool {
+	template <typename T, typename H = Handle>
+	struct TypedDynamicPool : BasicDynamicPool<H> {
+		typedef BasicDynamicPool<H> Base;
+
 		static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
 
-		TypedDynamicPool()
-			: DynamicPool(sizeof(T))
+		explicit TypedDynamicPool(PoolGrowth growth = PoolGrowth::contiguous)
+			: Base(sizeof(T), alignof(T), growth)
 		{}
 
-		Handle insert(const T& object) {
-			return insert(static_cast<const void*>(&object));
+		H insert(const T& object) {
+			return std::get<0>(Base::insert(&object));
+		}
+
+		/** Inserts copies of objects, writing their handles to out_handles. */
+		void insertBulk(Span<const T> objects, H* out_handles) {
+			Base::insertBulk(objects.data(), objects.size(), out_handles);
 		}
 
 		template <typename... Args>
-		Handle emplace(Args&&... params) {
-			Handle h;
+		H emplace(Args&&... params) {
+			H h;
 			void* inserted;
-			std::tie(h, inserted) = DynamicPool::insert(nullptr);
+			std::tie(h, inserted) = Base::insert(nullptr);
 			new (inserted) T(std::forward<Args>(params)...);
 			return h;
 		}
 
-		T* operator[] (const Handle h) {
-			return static_cast<T*>(DynamicPool::operator[](h));
+		/** All objects in the pool, densely packed. Only available with
+		 * contiguous growth, otherwise use forEachSpan. */
+		Span<T> objects() {
+			return Span<T>(static_cast<T*>(this->pool.begin()), this->pool.size());
+		}
+
+		Span<const T> objects() const {
+			return Span<const T>(static_cast<const T*>(this->pool.begin()), this->pool.size());
+		}
+
+		/** Calls f with a Span<T> for each contiguous range of objects. */
+		template <typename F>
+		void forEachSpan(F&& f) {
+			for (size_t i = 0; i < this->pool.size(); ) {
+				const size_t n = this->pool.contiguousCount(i);
+				f(Span<T>(static_cast<T*>(this->pool[i]), n));
+				i += n;
+			}
+		}
+
+		T* operator[] (const H h) {
+			return static_cast<T*>(Base::operator[](h));
 		}
 
-		const T* operator[] (const Handle h) const {
-			return static_cast<const T*>(DynamicPool::operator[](h));
+		const T* operator[] (const H h) const {
+			return static_cast<const T*>(Base::operator[](h));
 		}
 	};
 
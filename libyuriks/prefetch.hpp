@@ -0,0 +1,19 @@
+#pragma once
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#include <xmmintrin.h>
+#define YKS_HAS_PREFETCH 1
+#endif
+
+namespace yks {
+
+	/** Hints that the cache line containing p will be read soon. */
+	inline void prefetch(const void* p) {
+#ifdef YKS_HAS_PREFETCH
+		_mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+		(void) p;
+#endif
+	}
+
+}
@@ -0,0 +1,244 @@
+#include "CompiledSpriteDb.hpp"
+#include "SpriteDb.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace yks {
+
+	static const char MAGIC[4] = { 'Y', 'S', 'D', 'B' };
+
+	namespace {
+		struct NamedEntry {
+			const std::string* name;
+			uint32_t index;
+		};
+
+		// Adds entries' names to string pool and returns their keys, in the
+		// same (sorted) order as entries.
+		std::vector<CompiledSpriteDb::Key> makeKeys(const std::vector<NamedEntry>& entries, std::string& string_pool) {
+			std::vector<CompiledSpriteDb::Key> keys;
+			keys.reserve(entries.size());
+
+			for (const NamedEntry& e : entries) {
+				CompiledSpriteDb::Key key;
+				key.hash = CompiledSpriteDb::hashName(*e.name);
+				key.name_offset = uint32_t(string_pool.size());
+				key.name_length = uint32_t(e.name->size());
+				keys.push_back(key);
+
+				string_pool += *e.name;
+			}
+
+			return keys;
+		}
+
+		template <typename Map>
+		std::vector<NamedEntry> sortedEntries(const Map& map) {
+			std::vector<NamedEntry> entries;
+			entries.reserve(map.size());
+			for (const auto& i : map) {
+				entries.push_back(NamedEntry{ &i.first, uint32_t(i.second) });
+			}
+
+			std::sort(entries.begin(), entries.end(), [](const NamedEntry& a, const NamedEntry& b) {
+				return *a.name < *b.name;
+			});
+			return entries;
+		}
+
+		std::vector<uint32_t> makeBuckets(const std::vector<CompiledSpriteDb::Key>& keys) {
+			// At most half full, so probe sequences stay short.
+			uint32_t bucket_count = 1;
+			while (bucket_count < keys.size() * 2) {
+				bucket_count *= 2;
+			}
+
+			std::vector<uint32_t> buckets(bucket_count, CompiledSpriteDb::EMPTY_BUCKET);
+			for (uint32_t i = 0; i < keys.size(); ++i) {
+				uint32_t b = uint32_t(keys[i].hash) & (bucket_count - 1);
+				while (buckets[b] != CompiledSpriteDb::EMPTY_BUCKET) {
+					b = (b + 1) & (bucket_count - 1);
+				}
+				buckets[b] = i;
+			}
+
+			return buckets;
+		}
+
+		template <typename T>
+		bool writeArray(std::FILE* f, const T* data, size_t count) {
+			return count == 0 || std::fwrite(data, sizeof(T), count, f) == count;
+		}
+
+		struct FileCloser {
+			void operator()(std::FILE* f) const { std::fclose(f); }
+		};
+	}
+
+	bool writeCompiledSpriteDb(const SpriteDb& db, const std::string& filename) {
+		std::string string_pool;
+
+		const std::vector<NamedEntry> sprites = sortedEntries(db.sprite_ids);
+		const std::vector<CompiledSpriteDb::Key> sprite_keys = makeKeys(sprites, string_pool);
+		std::vector<IntRect> sprite_rects;
+		sprite_rects.reserve(sprites.size());
+		for (const NamedEntry& e : sprites) {
+			sprite_rects.push_back(db.sprites[e.index]);
+		}
+
+		// Sequences which disappeared on a reload are left empty in SpriteDb.
+		std::vector<NamedEntry> sequences = sortedEntries(db.sequence_ids);
+		sequences.erase(std::remove_if(sequences.begin(), sequences.end(), [&](const NamedEntry& e) {
+			return db.sequences[e.index].frame_count == 0;
+		}), sequences.end());
+		const std::vector<CompiledSpriteDb::Key> sequence_keys = makeKeys(sequences, string_pool);
+		std::vector<CompiledSpriteDb::SequenceRange> sequence_ranges;
+		sequence_ranges.reserve(sequences.size());
+		for (const NamedEntry& e : sequences) {
+			const SpriteDb::SequenceRange& r = db.sequences[e.index];
+			sequence_ranges.push_back(CompiledSpriteDb::SequenceRange{ r.first_frame, r.frame_count });
+		}
+
+		const std::vector<uint32_t> sprite_buckets = makeBuckets(sprite_keys);
+		const std::vector<uint32_t> sequence_buckets = makeBuckets(sequence_keys);
+
+		CompiledSpriteDb::Header header;
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version = CompiledSpriteDb::VERSION;
+		header.sprite_count = uint32_t(sprite_keys.size());
+		header.sequence_count = uint32_t(sequence_keys.size());
+		header.sequence_frame_count = uint32_t(db.sequence_frames.size());
+		header.string_pool_size = uint32_t(string_pool.size());
+		header.sprite_bucket_count = uint32_t(sprite_buckets.size());
+		header.sequence_bucket_count = uint32_t(sequence_buckets.size());
+
+		std::unique_ptr<std::FILE, FileCloser> f(std::fopen(filename.c_str(), "wb"));
+		if (!f)
+			return false;
+
+		const bool written = writeArray(f.get(), &header, 1) &&
+			writeArray(f.get(), sprite_keys.data(), sprite_keys.size()) &&
+			writeArray(f.get(), sprite_rects.data(), sprite_rects.size()) &&
+			writeArray(f.get(), sequence_keys.data(), sequence_keys.size()) &&
+			writeArray(f.get(), sequence_ranges.data(), sequence_ranges.size()) &&
+			writeArray(f.get(), db.sequence_frames.data(), db.sequence_frames.size()) &&
+			writeArray(f.get(), sprite_buckets.data(), sprite_buckets.size()) &&
+			writeArray(f.get(), sequence_buckets.data(), sequence_buckets.size()) &&
+			writeArray(f.get(), string_pool.data(), string_pool.size());
+
+		// fclose flushes, so it can still fail after every write succeeded
+		const bool closed = std::fclose(f.release()) == 0;
+		return written && closed;
+	}
+
+	CompiledSpriteDb::CompiledSpriteDb()
+		: header(nullptr),
+		sprite_keys(nullptr), sprite_rects(nullptr),
+		sequence_keys(nullptr), sequence_ranges(nullptr), sequence_frames(nullptr),
+		sprite_buckets(nullptr), sequence_buckets(nullptr),
+		string_pool(nullptr)
+	{}
+
+	bool CompiledSpriteDb::load(const std::string& filename) {
+		header = nullptr;
+		file = MappedFile(filename);
+		if (!file.isValid() || file.size() < sizeof(Header))
+			return false;
+
+		const Header* h = reinterpret_cast<const Header*>(file.data());
+		if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION)
+			return false;
+
+		auto is_pow2 = [](uint32_t x) { return x != 0 && (x & (x - 1)) == 0; };
+		if (!is_pow2(h->sprite_bucket_count) || !is_pow2(h->sequence_bucket_count))
+			return false;
+
+		const uint64_t expected_size = sizeof(Header) +
+			uint64_t(h->sprite_count) * (sizeof(Key) + sizeof(IntRect)) +
+			uint64_t(h->sequence_count) * (sizeof(Key) + sizeof(SequenceRange)) +
+			uint64_t(h->sequence_frame_count) * sizeof(IntRect) +
+			(uint64_t(h->sprite_bucket_count) + h->sequence_bucket_count) * sizeof(uint32_t) +
+			h->string_pool_size;
+		if (file.size() != expected_size)
+			return false;
+
+		const char* p = file.data() + sizeof(Header);
+		sprite_keys = reinterpret_cast<const Key*>(p);
+		p += h->sprite_count * sizeof(Key);
+		sprite_rects = reinterpret_cast<const IntRect*>(p);
+		p += h->sprite_count * sizeof(IntRect);
+		sequence_keys = reinterpret_cast<const Key*>(p);
+		p += h->sequence_count * sizeof(Key);
+		sequence_ranges = reinterpret_cast<const SequenceRange*>(p);
+		p += h->sequence_count * sizeof(SequenceRange);
+		sequence_frames = reinterpret_cast<const IntRect*>(p);
+		p += h->sequence_frame_count * sizeof(IntRect);
+		sprite_buckets = reinterpret_cast<const uint32_t*>(p);
+		p += h->sprite_bucket_count * sizeof(uint32_t);
+		sequence_buckets = reinterpret_cast<const uint32_t*>(p);
+		p += h->sequence_bucket_count * sizeof(uint32_t);
+		string_pool = p;
+
+		header = h;
+		return true;
+	}
+
+	const IntRect* CompiledSpriteDb::lookup(std::string_view id) const {
+		if (!isValid())
+			return nullptr;
+
+		const uint32_t i = findKey(sprite_keys, header->sprite_count, sprite_buckets, header->sprite_bucket_count, id);
+		return i != EMPTY_BUCKET ? &sprite_rects[i] : nullptr;
+	}
+
+	Span<const IntRect> CompiledSpriteDb::lookupSequence(std::string_view id_prefix) const {
+		if (!isValid())
+			return Span<const IntRect>();
+
+		const uint32_t i = findKey(sequence_keys, header->sequence_count, sequence_buckets, header->sequence_bucket_count, id_prefix);
+		if (i == EMPTY_BUCKET)
+			return Span<const IntRect>();
+
+		const SequenceRange& r = sequence_ranges[i];
+		if (uint64_t(r.first_frame) + r.frame_count > header->sequence_frame_count)
+			return Span<const IntRect>();
+		return Span<const IntRect>(sequence_frames + r.first_frame, r.frame_count);
+	}
+
+	uint64_t CompiledSpriteDb::hashName(std::string_view name) {
+		// 64-bit FNV-1a
+		uint64_t hash = 14695981039346656037ull;
+		for (char c : name) {
+			hash = (hash ^ uint8_t(c)) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	uint32_t CompiledSpriteDb::findKey(const Key* keys, uint32_t key_count, const uint32_t* buckets, uint32_t bucket_count, std::string_view name) const {
+		const uint64_t hash = hashName(name);
+
+		// load() only checked section sizes, so the entries a probe touches
+		// are checked here. A table without empty buckets ends after one
+		// pass over it.
+		uint32_t b = uint32_t(hash) & (bucket_count - 1);
+		for (uint32_t step = 0; step < bucket_count; ++step, b = (b + 1) & (bucket_count - 1)) {
+			// Also stops at empty buckets, since EMPTY_BUCKET >= key_count
+			const uint32_t i = buckets[b];
+			if (i >= key_count)
+				return EMPTY_BUCKET;
+
+			const Key& key = keys[i];
+			if (key.hash == hash &&
+				uint64_t(key.name_offset) + key.name_length <= header->string_pool_size &&
+				std::string_view(string_pool + key.name_offset, key.name_length) == name)
+			{
+				return i;
+			}
+		}
+		return EMPTY_BUCKET;
+	}
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "Sprite.hpp"
+#include "Span.hpp"
+#include "MappedFile.hpp"
+
+namespace yks {
+
+	struct SpriteDb;
+
+	/** Writes db to a binary file which can be used with CompiledSpriteDb.
+	 * The file uses native endianness. Returns false if writing failed. */
+	bool writeCompiledSpriteDb(const SpriteDb& db, const std::string& filename);
+
+	/** Read-only sprite database loaded from a file written by
+	 * writeCompiledSpriteDb(). The file is memory mapped and used as is:
+	 * loading doesn't parse or allocate anything, and lookups probe a hash
+	 * table stored in the file, comparing a single name in the common case. */
+	struct CompiledSpriteDb {
+		struct Header {
+			char magic[4];
+			uint32_t version;
+			uint32_t sprite_count;
+			uint32_t sequence_count;
+			uint32_t sequence_frame_count;
+			uint32_t string_pool_size;
+			uint32_t sprite_bucket_count; // Powers of 2
+			uint32_t sequence_bucket_count;
+		};
+
+		// Keys are sorted by name. Buckets hold indices into them, forming
+		// open addressing hash tables with linear probing.
+		struct Key {
+			uint64_t hash;
+			uint32_t name_offset; // Into string pool
+			uint32_t name_length;
+		};
+
+		static constexpr uint32_t EMPTY_BUCKET = UINT32_MAX;
+
+		struct SequenceRange {
+			uint32_t first_frame;
+			uint32_t frame_count;
+		};
+
+		static constexpr uint32_t VERSION = 1;
+
+		CompiledSpriteDb();
+
+		/** Maps filename and checks its header and section sizes, which
+		 * takes the same time for any size of table. Indices in the tables
+		 * are checked by lookups as they use them. Returns false if it isn't
+		 * valid. */
+		bool load(const std::string& filename);
+		bool isValid() const { return header != nullptr; }
+
+		size_t size() const { return header ? header->sprite_count : 0; }
+
+		/** Returns nullptr if there's no sprite named id. */
+		const IntRect* lookup(std::string_view id) const;
+		/** Returns an empty span if there's no sequence with that prefix. */
+		Span<const IntRect> lookupSequence(std::string_view id_prefix) const;
+
+		/** Hash used for keys. Stable across platforms, since it's stored. */
+		static uint64_t hashName(std::string_view name);
+
+	private:
+		MappedFile file;
+
+		const Header* header;
+		const Key* sprite_keys;
+		const IntRect* sprite_rects;
+		const Key* sequence_keys;
+		const SequenceRange* sequence_ranges;
+		const IntRect* sequence_frames;
+		const uint32_t* sprite_buckets;
+		const uint32_t* sequence_buckets;
+		const char* string_pool;
+
+		/** Index of name in keys, or EMPTY_BUCKET if not found. */
+		uint32_t findKey(const Key* keys, uint32_t key_count, const uint32_t* buckets, uint32_t bucket_count, std::string_view name) const;
+	};
+
+}
@@ -16,6 +16,12 @@ namespace yks {
 		int w, h;
 	};
 
+	/** Texture coordinates of a sprite, already normalized by texture size. */
+	struct UvRect {
+		float s0, t0;
+		float s1, t1;
+	};
+
 	struct Sprite {
 		SpriteMatrix mat;
 		IntRect img;
@@ -0,0 +1,162 @@
+#include "SpriteBatch.hpp"
+#include "SpriteBatchKernels.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace yks {
+
+	using namespace sprite_batch;
+
+	namespace {
+#ifdef YKS_HAS_SSE2
+		struct Sse2Lanes {
+			typedef __m128 V;
+			static const size_t width = 4;
+
+			static V load(const float* p) { return _mm_loadu_ps(p); }
+			static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+			static V set1(float f) { return _mm_set1_ps(f); }
+			static V add(V a, V b) { return _mm_add_ps(a, b); }
+			static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+			static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+			static V div(V a, V b) { return _mm_div_ps(a, b); }
+			static V neg(V a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+		};
+#endif
+
+		Kernels chooseKernels() {
+			Kernels kernels;
+			if (cpuSupportsAvx2() && getAvx2Kernels(kernels))
+				return kernels;
+#ifdef YKS_HAS_SSE2
+			return makeKernels<Sse2Lanes>("sse2");
+#else
+			return makeKernels<ScalarLanes>("scalar");
+#endif
+		}
+
+		const Kernels& getKernels() {
+			static const Kernels kernels = chooseKernels();
+			return kernels;
+		}
+
+		ConstMatrixArrays arraysOf(const SpriteMatrixArray& a, size_t offset) {
+			ConstMatrixArrays r;
+			for (unsigned int i = 0; i < 2; ++i) {
+				for (unsigned int j = 0; j < 3; ++j) {
+					r.m[i][j] = a.m[i][j].data() + offset;
+				}
+			}
+			return r;
+		}
+
+		MatrixArrays arraysOf(SpriteMatrixArray& a, size_t offset) {
+			MatrixArrays r;
+			for (unsigned int i = 0; i < 2; ++i) {
+				for (unsigned int j = 0; j < 3; ++j) {
+					r.m[i][j] = a.m[i][j].data() + offset;
+				}
+			}
+			return r;
+		}
+	}
+
+	void SpriteMatrixArray::resize(size_t count) {
+		for (auto& row : m) {
+			for (std::vector<float>& elements : row) {
+				elements.resize(count);
+			}
+		}
+	}
+
+	void SpriteMatrixArray::set(size_t k, const SpriteMatrix& mat) {
+		for (unsigned int i = 0; i < 2; ++i) {
+			for (unsigned int j = 0; j < 3; ++j) {
+				m[i][j][k] = mat.m(i, j);
+			}
+		}
+	}
+
+	SpriteMatrix SpriteMatrixArray::get(size_t k) const {
+		SpriteMatrix mat;
+		for (unsigned int i = 0; i < 2; ++i) {
+			for (unsigned int j = 0; j < 3; ++j) {
+				mat.m(i, j) = m[i][j][k];
+			}
+		}
+		return mat;
+	}
+
+	void transformPoints(const SpriteMatrix& m, const float* x, const float* y, float* out_x, float* out_y, size_t count) {
+		const float* mat = m.m.as_row_major();
+		const size_t done = getKernels().transform_one(mat, x, y, out_x, out_y, count);
+		transformOne<ScalarLanes>(mat, x + done, y + done, out_x + done, out_y + done, count - done);
+	}
+
+	void transformPoints(const SpriteMatrixArray& m, const float* x, const float* y, float* out_x, float* out_y) {
+		const size_t count = m.size();
+		const size_t done = getKernels().transform_many(arraysOf(m, 0), x, y, out_x, out_y, count);
+		transformMany<ScalarLanes>(arraysOf(m, done), x + done, y + done, out_x + done, out_y + done, count - done);
+	}
+
+	void multiplyMatrices(SpriteMatrixArray& m, const SpriteMatrixArray& l) {
+		assert(l.size() == m.size());
+		const size_t count = m.size();
+		const size_t done = getKernels().multiply(arraysOf(m, 0), arraysOf(l, 0), count);
+		multiply<ScalarLanes>(arraysOf(m, done), arraysOf(l, done), count - done);
+	}
+
+	void invertMatrices(SpriteMatrixArray& m) {
+		const size_t count = m.size();
+		const size_t done = getKernels().invert(arraysOf(m, 0), count);
+		invert<ScalarLanes>(arraysOf(m, done), count - done);
+	}
+
+	const char* getSpriteBatchIsa() {
+		return getKernels().isa;
+	}
+
+	void SpriteHitTester::build(Span<const Sprite> sprites) {
+		inverse.resize(sprites.size());
+		widths.resize(sprites.size());
+		heights.resize(sprites.size());
+		for (size_t k = 0; k < sprites.size(); ++k) {
+			inverse.set(k, sprites[k].mat);
+			widths[k] = static_cast<float>(sprites[k].img.w);
+			heights[k] = static_cast<float>(sprites[k].img.h);
+		}
+		invertMatrices(inverse);
+	}
+
+	size_t SpriteHitTester::find(vec2 p) {
+		const Kernels& kernels = getKernels();
+		const SpriteMatrixArray& matrices = inverse;
+		// One vector per block, so a hit near the top skips the rest. Longer
+		// blocks weren't faster on the hit test benchmark.
+		const size_t block_size = kernels.width;
+		query_x.assign(block_size, p[0]);
+		query_y.assign(block_size, p[1]);
+		local_x.resize(block_size);
+		local_y.resize(block_size);
+
+		for (size_t end = inverse.size(); end > 0; ) {
+			const size_t begin = end > block_size ? end - block_size : 0;
+			const size_t count = end - begin;
+			const size_t done = kernels.transform_many(arraysOf(matrices, begin),
+				query_x.data(), query_y.data(), local_x.data(), local_y.data(), count);
+			transformMany<ScalarLanes>(arraysOf(matrices, begin + done),
+				query_x.data() + done, query_y.data() + done, local_x.data() + done, local_y.data() + done, count - done);
+
+			for (size_t i = count; i-- > 0; ) {
+				const size_t k = begin + i;
+				if (local_x[i] >= 0.0f && local_x[i] < widths[k] && local_y[i] >= 0.0f && local_y[i] < heights[k])
+					return k;
+			}
+			end = begin;
+		}
+		return SIZE_MAX;
+	}
+
+}
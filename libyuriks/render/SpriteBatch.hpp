@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "./Sprite.hpp"
+#include "./SpriteMatrix.hpp"
+#include "math/vec.hpp"
+#include "Span.hpp"
+
+namespace yks {
+
+	/** Many SpriteMatrix stored as one array per element, as used by the
+	 * batch functions below. m[i][j][k] is element (i, j) of matrix k. */
+	struct SpriteMatrixArray {
+		std::vector<float> m[2][3];
+
+		size_t size() const { return m[0][0].size(); }
+		void resize(size_t count);
+		void clear() { resize(0); }
+
+		void set(size_t k, const SpriteMatrix& mat);
+		SpriteMatrix get(size_t k) const;
+	};
+
+	// Batch versions of the SpriteMatrix operations. They're vectorized with
+	// SSE2, or AVX2 if the CPU supports it, and give the same results as the
+	// SpriteMatrix functions. Output arrays may be the same as input ones.
+
+	/** Transforms count points, given as x and y arrays, by m. */
+	void transformPoints(const SpriteMatrix& m, const float* x, const float* y, float* out_x, float* out_y, size_t count);
+	/** Transforms the k-th point by the k-th matrix, for all matrices in m. */
+	void transformPoints(const SpriteMatrixArray& m, const float* x, const float* y, float* out_x, float* out_y);
+	/** m[k].multiply(l[k]) for all k. */
+	void multiplyMatrices(SpriteMatrixArray& m, const SpriteMatrixArray& l);
+	/** m[k] = m[k].inverse() for all k. */
+	void invertMatrices(SpriteMatrixArray& m);
+
+	/** Name of the instruction set used by the batch functions. */
+	const char* getSpriteBatchIsa();
+
+	/** Finds which of many, possibly rotated, sprites is under a point. The
+	 * sprites are inverted once in build(), so each query only transforms
+	 * the point into the space of every sprite. */
+	struct SpriteHitTester {
+		/** Keeps the inverse transforms of sprites, which must not be singular. */
+		void build(Span<const Sprite> sprites);
+		/** Returns the index of the last sprite containing p, so the topmost
+		 * one if they were drawn in order, or SIZE_MAX if there's none.
+		 * Sprites are tested from the top one vector at a time, stopping at
+		 * the first block with a hit. */
+		size_t find(vec2 p);
+
+	private:
+		SpriteMatrixArray inverse;
+		std::vector<float> widths;
+		std::vector<float> heights;
+		// Scratch space for queries, one block long
+		std::vector<float> query_x;
+		std::vector<float> query_y;
+		std::vector<float> local_x;
+		std::vector<float> local_y;
+	};
+
+}
@@ -0,0 +1,40 @@
+// Compiled with AVX2 enabled (see premake5.lua). Only code which is called
+// after checking the CPU supports it may live here.
+#include "SpriteBatchKernels.hpp"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace yks {
+	namespace sprite_batch {
+
+#ifdef __AVX2__
+		namespace {
+			struct Avx2Lanes {
+				typedef __m256 V;
+				static const size_t width = 8;
+
+				static V load(const float* p) { return _mm256_loadu_ps(p); }
+				static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+				static V set1(float f) { return _mm256_set1_ps(f); }
+				static V add(V a, V b) { return _mm256_add_ps(a, b); }
+				static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+				static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+				static V div(V a, V b) { return _mm256_div_ps(a, b); }
+				static V neg(V a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+			};
+		}
+
+		bool getAvx2Kernels(Kernels& out) {
+			out = makeKernels<Avx2Lanes>("avx2");
+			return true;
+		}
+#else
+		bool getAvx2Kernels(Kernels&) {
+			return false;
+		}
+#endif
+
+	}
+}
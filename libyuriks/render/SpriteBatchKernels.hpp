@@ -0,0 +1,153 @@
+#pragma once
+
+// Kernels of the SpriteBatch functions, written once for any vector width.
+// This is included by SpriteBatchAvx2.cpp, which is compiled with AVX2
+// enabled, so it must not include anything with inline functions that might
+// get shared with code which runs on CPUs without it.
+
+#include <cstddef>
+
+namespace yks {
+	namespace sprite_batch {
+
+		/** Matrices as six arrays, m[i][j] holding element (i, j) of each. */
+		struct ConstMatrixArrays {
+			const float* m[2][3];
+		};
+
+		struct MatrixArrays {
+			float* m[2][3];
+		};
+
+		/** Each kernel handles as many items as fit in full vectors and returns
+		 * how many that was. The rest are done by the scalar version. */
+		struct Kernels {
+			const char* isa;
+			/** Floats per vector. */
+			size_t width;
+			/** mat holds the 6 elements of a SpriteMatrix in row major order. */
+			size_t (*transform_one)(const float* mat, const float* x, const float* y, float* out_x, float* out_y, size_t count);
+			size_t (*transform_many)(ConstMatrixArrays m, const float* x, const float* y, float* out_x, float* out_y, size_t count);
+			size_t (*multiply)(MatrixArrays m, ConstMatrixArrays l, size_t count);
+			size_t (*invert)(MatrixArrays m, size_t count);
+		};
+
+		/** Returns false if AVX2 kernels weren't compiled in. Only call them on
+		 * CPUs supporting AVX2. */
+		bool getAvx2Kernels(Kernels& out);
+
+		namespace {
+
+			// Lanes types wrap the operations on one vector of floats. Kernels
+			// must do the same operations in the same order as the scalar
+			// SpriteMatrix functions, so that results don't depend on which kernel
+			// ran.
+
+			struct ScalarLanes {
+				typedef float V;
+				static const size_t width = 1;
+
+				static V load(const float* p) { return *p; }
+				static void store(float* p, V v) { *p = v; }
+				static V set1(float f) { return f; }
+				static V add(V a, V b) { return a + b; }
+				static V mul(V a, V b) { return a * b; }
+				static V sub(V a, V b) { return a - b; }
+				static V div(V a, V b) { return a / b; }
+				static V neg(V a) { return -a; }
+			};
+
+			template <typename L>
+			size_t transformOne(const float* mat, const float* x, const float* y, float* out_x, float* out_y, size_t count) {
+				typedef typename L::V V;
+				const V a = L::set1(mat[0]), b = L::set1(mat[1]), c = L::set1(mat[2]);
+				const V d = L::set1(mat[3]), e = L::set1(mat[4]), f = L::set1(mat[5]);
+
+				size_t i = 0;
+				for (; i + L::width <= count; i += L::width) {
+					const V px = L::load(x + i);
+					const V py = L::load(y + i);
+					L::store(out_x + i, L::add(L::add(L::mul(a, px), L::mul(b, py)), c));
+					L::store(out_y + i, L::add(L::add(L::mul(d, px), L::mul(e, py)), f));
+				}
+				return i;
+			}
+
+			template <typename L>
+			size_t transformMany(ConstMatrixArrays m, const float* x, const float* y, float* out_x, float* out_y, size_t count) {
+				typedef typename L::V V;
+
+				size_t i = 0;
+				for (; i + L::width <= count; i += L::width) {
+					const V px = L::load(x + i);
+					const V py = L::load(y + i);
+					const V a = L::load(m.m[0][0] + i), b = L::load(m.m[0][1] + i), c = L::load(m.m[0][2] + i);
+					const V d = L::load(m.m[1][0] + i), e = L::load(m.m[1][1] + i), f = L::load(m.m[1][2] + i);
+					L::store(out_x + i, L::add(L::add(L::mul(a, px), L::mul(b, py)), c));
+					L::store(out_y + i, L::add(L::add(L::mul(d, px), L::mul(e, py)), f));
+				}
+				return i;
+			}
+
+			template <typename L>
+			size_t multiply(MatrixArrays m, ConstMatrixArrays l, size_t count) {
+				typedef typename L::V V;
+
+				size_t i = 0;
+				for (; i + L::width <= count; i += L::width) {
+					const V a = L::load(m.m[0][0] + i), b = L::load(m.m[0][1] + i), c = L::load(m.m[0][2] + i);
+					const V d = L::load(m.m[1][0] + i), e = L::load(m.m[1][1] + i), f = L::load(m.m[1][2] + i);
+					const V A = L::load(l.m[0][0] + i), B = L::load(l.m[0][1] + i), C = L::load(l.m[0][2] + i);
+					const V D = L::load(l.m[1][0] + i), E = L::load(l.m[1][1] + i), F = L::load(l.m[1][2] + i);
+
+					L::store(m.m[0][0] + i, L::add(L::mul(a, A), L::mul(b, D)));
+					L::store(m.m[0][1] + i, L::add(L::mul(a, B), L::mul(b, E)));
+					L::store(m.m[0][2] + i, L::add(L::add(L::mul(a, C), L::mul(b, F)), c));
+					L::store(m.m[1][0] + i, L::add(L::mul(d, A), L::mul(e, D)));
+					L::store(m.m[1][1] + i, L::add(L::mul(d, B), L::mul(e, E)));
+					L::store(m.m[1][2] + i, L::add(L::add(L::mul(d, C), L::mul(e, F)), f));
+				}
+				return i;
+			}
+
+			template <typename L>
+			size_t invert(MatrixArrays m, size_t count) {
+				typedef typename L::V V;
+				const V one = L::set1(1.0f);
+
+				size_t i = 0;
+				for (; i + L::width <= count; i += L::width) {
+					const V a = L::load(m.m[0][0] + i), b = L::load(m.m[0][1] + i), c = L::load(m.m[0][2] + i);
+					const V d = L::load(m.m[1][0] + i), e = L::load(m.m[1][1] + i), f = L::load(m.m[1][2] + i);
+					const V inv_det = L::div(one, L::sub(L::mul(a, e), L::mul(b, d)));
+
+					const V ra = L::mul(e, inv_det);
+					const V rb = L::mul(L::neg(b), inv_det);
+					const V rd = L::mul(L::neg(d), inv_det);
+					const V re = L::mul(a, inv_det);
+					L::store(m.m[0][0] + i, ra);
+					L::store(m.m[0][1] + i, rb);
+					L::store(m.m[0][2] + i, L::neg(L::add(L::mul(ra, c), L::mul(rb, f))));
+					L::store(m.m[1][0] + i, rd);
+					L::store(m.m[1][1] + i, re);
+					L::store(m.m[1][2] + i, L::neg(L::add(L::mul(rd, c), L::mul(re, f))));
+				}
+				return i;
+			}
+
+			template <typename L>
+			Kernels makeKernels(const char* isa) {
+				Kernels k;
+				k.isa = isa;
+				k.width = L::width;
+				k.transform_one = &transformOne<L>;
+				k.transform_many = &transformMany<L>;
+				k.multiply = &multiply<L>;
+				k.invert = &invert<L>;
+				return k;
+			}
+
+		}
+
+	}
+}
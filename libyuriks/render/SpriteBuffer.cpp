@@ -19,6 +19,19 @@ namespace yks {
 		YKS_CHECK_GL_PARANOID;
 	}
 
+	void appendTranslatedVertices(std::vector<VertexData>& dst, Span<const VertexData> src, vec2 offset) {
+		// Inserting all at once avoids both per-element capacity checks and
+		// the zero-initialization resize() would do.
+		const size_t old_size = dst.size();
+		dst.insert(dst.end(), src.begin(), src.end());
+
+		VertexData* out = dst.data() + old_size;
+		for (size_t i = 0; i < src.size(); ++i) {
+			out[i].pos_x += offset[0];
+			out[i].pos_y += offset[1];
+		}
+	}
+
 	SpriteBufferIndices::SpriteBufferIndices() {
 		YKS_CHECK_GL_PARANOID;
 
@@ -67,17 +80,33 @@ namespace yks {
 		sprite_count = 0;
 	}
 
-	void SpriteBuffer::append(const Sprite& spr) {
+	void makeUvRects(Span<const IntRect> rects, vec2i texture_size, Span<UvRect> uvs) {
 		assert(texture_size[0] >= 0 && texture_size[1] >= 0);
+		assert(rects.size() == uvs.size());
+
+		const float inv_tex_w = 1.0f / static_cast<float>(texture_size[0]);
+		const float inv_tex_h = 1.0f / static_cast<float>(texture_size[1]);
+
+		for (size_t i = 0; i < rects.size(); ++i) {
+			const IntRect& img = rects[i];
+			UvRect& uv = uvs[i];
+			uv.s0 = img.x * inv_tex_w;
+			uv.t0 = img.y * inv_tex_h;
+			uv.s1 = (img.x + img.w) * inv_tex_w;
+			uv.t1 = (img.y + img.h) * inv_tex_h;
+		}
+	}
 
+	void SpriteBuffer::append(const Sprite& spr) {
+		UvRect uv;
+		makeUvRects(Span<const IntRect>(&spr.img, 1), texture_size, Span<UvRect>(&uv, 1));
+		append(spr, uv);
+	}
+
+	void SpriteBuffer::append(const Sprite& spr, const UvRect& uv) {
 		float spr_w = static_cast<float>(spr.img.w);
 		float spr_h = static_cast<float>(spr.img.h);
 
-		float img_x = spr.img.x / static_cast<float>(texture_size[0]);
-		float img_w = spr.img.w / static_cast<float>(texture_size[0]);
-		float img_y = spr.img.y / static_cast<float>(texture_size[1]);
-		float img_h = spr.img.h / static_cast<float>(texture_size[1]);
-
 		VertexData v;
 		v.color[0] = spr.color.r;
 		v.color[1] = spr.color.g;
@@ -87,31 +116,87 @@ namespace yks {
 		auto p = spr.mat.transform(mvec2(0.f, 0.f));
 		v.pos_x = p[0];
 		v.pos_y = p[1];
-		v.tex_s = img_x;
-		v.tex_t = img_y;
+		v.tex_s = uv.s0;
+		v.tex_t = uv.t0;
 		vertices.push_back(v);
 
 		p = spr.mat.transform(mvec2(spr_w, 0.f));
 		v.pos_x = p[0];
 		v.pos_y = p[1];
-		v.tex_s = img_x + img_w;
+		v.tex_s = uv.s1;
 		vertices.push_back(v);
 
 		p = spr.mat.transform(mvec2(spr_w, spr_h));
 		v.pos_x = p[0];
 		v.pos_y = p[1];
-		v.tex_t = img_y + img_h;
+		v.tex_t = uv.t1;
 		vertices.push_back(v);
 
 		p = spr.mat.transform(mvec2(0.f, spr_h));
 		v.pos_x = p[0];
 		v.pos_y = p[1];
-		v.tex_s = img_x;
+		v.tex_s = uv.s0;
 		vertices.push_back(v);
 
 		sprite_count += 1;
 	}
 
+	void SpriteBuffer::append(Span<const Sprite> sprites, Span<const UvRect> uvs) {
+		assert(sprites.size() == uvs.size());
+		const size_t count = sprites.size();
+
+		// Corners are stored corner-major: corner c of sprite i is at c * count + i
+		batch_mats.resize(count);
+		corner_x.resize(count * 4);
+		corner_y.resize(count * 4);
+		for (size_t i = 0; i < count; ++i) {
+			const Sprite& spr = sprites[i];
+			const float spr_w = static_cast<float>(spr.img.w);
+			const float spr_h = static_cast<float>(spr.img.h);
+
+			batch_mats.set(i, spr.mat);
+			corner_x[0 * count + i] = 0.f;   corner_y[0 * count + i] = 0.f;
+			corner_x[1 * count + i] = spr_w; corner_y[1 * count + i] = 0.f;
+			corner_x[2 * count + i] = spr_w; corner_y[2 * count + i] = spr_h;
+			corner_x[3 * count + i] = 0.f;   corner_y[3 * count + i] = spr_h;
+		}
+		for (size_t c = 0; c < 4; ++c) {
+			float* x = corner_x.data() + c * count;
+			float* y = corner_y.data() + c * count;
+			transformPoints(batch_mats, x, y, x, y);
+		}
+
+		const size_t old_size = vertices.size();
+		vertices.resize(old_size + count * 4);
+		VertexData* out = vertices.data() + old_size;
+		for (size_t i = 0; i < count; ++i) {
+			const Color& col = sprites[i].color;
+			const UvRect& uv = uvs[i];
+			const float tex_s[4] = { uv.s0, uv.s1, uv.s1, uv.s0 };
+			const float tex_t[4] = { uv.t0, uv.t0, uv.t1, uv.t1 };
+
+			for (size_t c = 0; c < 4; ++c) {
+				VertexData& v = out[i * 4 + c];
+				v.pos_x = corner_x[c * count + i];
+				v.pos_y = corner_y[c * count + i];
+				v.tex_s = tex_s[c];
+				v.tex_t = tex_t[c];
+				v.color[0] = col.r;
+				v.color[1] = col.g;
+				v.color[2] = col.b;
+				v.color[3] = col.a;
+			}
+		}
+
+		sprite_count += static_cast<unsigned int>(count);
+	}
+
+	void SpriteBuffer::appendVertices(Span<const VertexData> quads, vec2 offset) {
+		assert(quads.size() % 4 == 0);
+		appendTranslatedVertices(vertices, quads, offset);
+		sprite_count += static_cast<unsigned int>(quads.size() / 4);
+	}
+
 	void SpriteBuffer::draw(SpriteBufferIndices& indices) const {
 		YKS_CHECK_GL_PARANOID;
 
@@ -4,8 +4,10 @@
 #include "gl/gl_assert.hpp"
 #include "gl/Buffer.hpp"
 #include "./Sprite.hpp"
+#include "./SpriteBatch.hpp"
 #include "math/vec.hpp"
 #include "math/mat.hpp"
+#include "Span.hpp"
 #include <memory>
 
 namespace yks {
@@ -18,6 +20,14 @@ namespace yks {
 		static void setupVertexAttribs();
 	};
 
+	/** Appends src to dst, moving each vertex by offset. */
+	void appendTranslatedVertices(std::vector<VertexData>& dst, Span<const VertexData> src, vec2 offset);
+
+	/** Normalizes rects by texture_size into uvs, for the SpriteBuffer::append()
+	 * overloads taking UvRects. Sprites with fixed rects can keep the result
+	 * and only recompute it when the texture changes size. */
+	void makeUvRects(Span<const IntRect> rects, vec2i texture_size, Span<UvRect> uvs);
+
 	struct SpriteBufferIndices {
 		std::vector<uint16_t> indices;
 		unsigned int index_count = 0;
@@ -39,8 +49,22 @@ namespace yks {
 
 		void clear();
 		void append(const Sprite& spr);
+		/** Appends sprite using precomputed texture coordinates instead of
+		 * deriving them from spr.img and texture_size. */
+		void append(const Sprite& spr, const UvRect& uv);
+		/** Appends sprites[i] with texture coordinates uvs[i], transforming
+		 * the corners of all of them at once. */
+		void append(Span<const Sprite> sprites, Span<const UvRect> uvs);
+		/** Appends already built sprite quads (4 vertices each), moved by offset. */
+		void appendVertices(Span<const VertexData> quads, vec2 offset);
 
 		void draw(SpriteBufferIndices& indices) const;
+
+	private:
+		// Scratch space for the batch append
+		SpriteMatrixArray batch_mats;
+		std::vector<float> corner_x;
+		std::vector<float> corner_y;
 	};
 
 }
@@ -1,42 +1,195 @@
 #include "SpriteDb.hpp"
-#include <fstream>
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <thread>
 #include "csv.hpp"
+#include "MappedFile.hpp"
 
 namespace yks {
 
+	namespace {
+		struct CsvSprite {
+			std::string_view id;
+			IntRect rect;
+		};
+
+		void parseCsvSprites(std::string_view data, std::vector<CsvSprite>& sprites) {
+			sprites.reserve(data.size() / 16);
+
+			CsvReader csv(data);
+			while (csv.nextRow()) {
+				CsvSprite s;
+				s.id = csv.nextField();
+
+				bool ok = parseCsvInt(csv.nextField(), s.rect.x);
+				ok = parseCsvInt(csv.nextField(), s.rect.y) && ok;
+				ok = parseCsvInt(csv.nextField(), s.rect.w) && ok;
+				ok = parseCsvInt(csv.nextField(), s.rect.h) && ok;
+				assert(ok); // TODO: ERROR_CHECK
+				(void) ok;
+
+				sprites.push_back(s);
+			}
+		}
+	}
+
 	void SpriteDb::loadFromCsv(const std::string& filename) {
-		std::fstream f(filename);
-		assert(f); // TODO: ERROR_CHECK
+		MappedFile f(filename);
+		assert(f.isValid()); // TODO: ERROR_CHECK
+
+		// Big files are parsed in parallel, but sprites are still interned
+		// in file order so ids don't depend on the number of threads.
+		static const size_t PARALLEL_PARSE_MIN_SIZE = 1 << 20;
+		size_t num_threads = 1;
+		if (f.size() >= PARALLEL_PARSE_MIN_SIZE) {
+			num_threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		const std::vector<std::string_view> chunks = splitCsvChunks(f.view(), num_threads);
+		std::vector<std::vector<CsvSprite>> parsed(chunks.size());
+
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < chunks.size(); ++i) {
+			threads.emplace_back(parseCsvSprites, chunks[i], std::ref(parsed[i]));
+		}
+		if (!chunks.empty()) {
+			parseCsvSprites(chunks[0], parsed[0]);
+		}
+		for (std::thread& t : threads) {
+			t.join();
+		}
+
+		size_t num_sprites = 0;
+		for (const auto& chunk_sprites : parsed) {
+			num_sprites += chunk_sprites.size();
+		}
+		sprite_ids.reserve(sprite_ids.size() + num_sprites);
+		sprites.reserve(sprites.size() + num_sprites);
+
+		for (const auto& chunk_sprites : parsed) {
+			for (const CsvSprite& s : chunk_sprites) {
+				const SpriteId sprite = intern(s.id);
+				sprites[sprite] = s.rect;
+			}
+		}
+
+		buildSequences();
+	}
 
-		std::string line;
-		while (std::getline(f, line)) {
-			std::string::size_type pos = 0;
+	void SpriteDb::mergeFrom(const SpriteDb& o) {
+		for (const auto& entry : o.sprite_ids) {
+			const SpriteId sprite = intern(entry.first);
+			sprites[sprite] = o.sprites[entry.second];
+		}
+
+		buildSequences();
+	}
+
+	SpriteId SpriteDb::lookupId(std::string_view id) const {
+		auto i = sprite_ids.find(id);
+		return i != sprite_ids.end() ? i->second : invalid_sprite_id;
+	}
 
-			std::string id = getNextCsvField(line, pos);
+	SequenceId SpriteDb::lookupSequenceId(std::string_view id_prefix) const {
+		auto i = sequence_ids.find(id_prefix);
+		return i != sequence_ids.end() ? i->second : invalid_sequence_id;
+	}
+
+	Span<const IntRect> SpriteDb::lookupSequence(SequenceId id) const {
+		if (id >= sequences.size())
+			return Span<const IntRect>();
 
-			IntRect r;
-			r.x = std::stoi(getNextCsvField(line, pos));
-			r.y = std::stoi(getNextCsvField(line, pos));
-			r.w = std::stoi(getNextCsvField(line, pos));
-			r.h = std::stoi(getNextCsvField(line, pos));
+		const SequenceRange& seq = sequences[id];
+		return Span<const IntRect>(sequence_frames.data() + seq.first_frame, seq.frame_count);
+	}
+
+	Span<const IntRect> SpriteDb::lookupSequence(std::string_view id_prefix) const {
+		return lookupSequence(lookupSequenceId(id_prefix));
+	}
 
-			sprite_db.insert(std::make_pair(id, r));
+	SpriteId SpriteDb::intern(std::string_view id) {
+		auto inserted = sprite_ids.emplace(id, SpriteId(sprites.size()));
+		if (inserted.second) {
+			sprites.push_back(IntRect{ 0, 0, 0, 0 });
 		}
+		return inserted.first->second;
 	}
 
-	std::vector<IntRect> SpriteDb::lookupSequence(const std::string& id_prefix) const {
-		std::vector<IntRect> seq;
-		int frame = 1;
+	void SpriteDb::buildSequences() {
+		// Gather (prefix, frame number) pairs. A sprite ending in more than
+		// one digit belongs to several candidate sequences, since e.g. "a12"
+		// could be either frame 12 of "a" or frame 2 of "a1".
+		struct Frame {
+			const std::string* name;
+			std::string::size_type prefix_len;
+			unsigned long number;
+			SpriteId sprite;
+		};
+		std::vector<Frame> frames;
 
-		auto i = sprite_db.find(id_prefix + std::to_string(frame));
-		while (i != sprite_db.end()) {
-			seq.push_back(i->second);
-			++frame;
-			i = sprite_db.find(id_prefix + std::to_string(frame));
+		for (const auto& entry : sprite_ids) {
+			const std::string& name = entry.first;
+			std::string::size_type digits_begin = name.size();
+			while (digits_begin > 0 && name[digits_begin - 1] >= '0' && name[digits_begin - 1] <= '9') {
+				--digits_begin;
+			}
+
+			// Walk from the end so the number can be accumulated as we go.
+			unsigned long number = 0;
+			unsigned long digit_value = 1;
+			for (std::string::size_type i = name.size(); i > digits_begin && name.size() - i < 9; ) {
+				--i;
+				number += (name[i] - '0') * digit_value;
+				digit_value *= 10;
+
+				if (name[i] != '0') { // to_string never produces leading zeros
+					frames.push_back(Frame{ &name, i, number, entry.second });
+				}
+			}
+		}
+
+		std::sort(frames.begin(), frames.end(), [](const Frame& a, const Frame& b) {
+			const int c = a.name->compare(0, a.prefix_len, *b.name, 0, b.prefix_len);
+			return c != 0 ? c < 0 : a.number < b.number;
+		});
+
+		// Existing sequence ids are kept, but emptied in case they disappeared.
+		for (SequenceRange& seq : sequences) {
+			seq = SequenceRange{ 0, 0 };
 		}
+		sequence_frames.clear();
 
-		return seq;
+		for (size_t i = 0; i < frames.size(); ) {
+			const Frame& first = frames[i];
+			std::string prefix = first.name->substr(0, first.prefix_len);
+
+			size_t group_end = i;
+			while (group_end < frames.size() &&
+				frames[group_end].name->compare(0, frames[group_end].prefix_len, prefix) == 0)
+			{
+				++group_end;
+			}
+
+			// Only the run of frames numbered from 1 without gaps counts.
+			const uint32_t first_frame = uint32_t(sequence_frames.size());
+			unsigned long expected_number = 1;
+			for (size_t j = i; j < group_end && frames[j].number == expected_number; ++j) {
+				sequence_frames.push_back(sprites[frames[j].sprite]);
+				++expected_number;
+			}
+
+			const uint32_t frame_count = uint32_t(sequence_frames.size()) - first_frame;
+			if (frame_count != 0) {
+				auto inserted = sequence_ids.emplace(std::move(prefix), SequenceId(sequences.size()));
+				if (inserted.second) {
+					sequences.push_back(SequenceRange());
+				}
+				sequences[inserted.first->second] = SequenceRange{ first_frame, frame_count };
+			}
+
+			i = group_end;
+		}
 	}
 
 }
@@ -1,17 +1,60 @@
 #pragma once
 
-#include <unordered_map>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "FlatHashMap.hpp"
 #include "Sprite.hpp"
+#include "Span.hpp"
 
 namespace yks {
 
+	/** Dense index of a sprite in a SpriteDb. Stays the same if the database
+	 * is reloaded with mergeFrom(). */
+	typedef uint32_t SpriteId;
+	/** Dense index of a sprite sequence in a SpriteDb. */
+	typedef uint32_t SequenceId;
+
+	static const SpriteId invalid_sprite_id = UINT32_MAX;
+	static const SequenceId invalid_sequence_id = UINT32_MAX;
+
 	struct SpriteDb {
-		std::unordered_map<std::string, IntRect> sprite_db;
+		FlatHashMap<std::string, SpriteId> sprite_ids;
+		std::vector<IntRect> sprites; // Indexed by SpriteId
+
+		// A sequence is a run of sprites named prefix1, prefix2, ..., prefixN.
+		// Their frames are copied into a contiguous array when loading, so
+		// looking one up doesn't need to build or hash any strings.
+		struct SequenceRange {
+			uint32_t first_frame;
+			uint32_t frame_count;
+		};
+		FlatHashMap<std::string, SequenceId> sequence_ids;
+		std::vector<SequenceRange> sequences; // Indexed by SequenceId
+		std::vector<IntRect> sequence_frames;
+
+		/** Returns invalid_sprite_id if there's no sprite named id. */
+		SpriteId lookupId(std::string_view id) const;
+		const IntRect& lookup(SpriteId id) const { return sprites[id]; }
+		/** Throws std::out_of_range if there's no sprite named id. */
+		IntRect lookup(std::string_view id) const { return sprites[sprite_ids.at(id)]; }
+
+		/** Returns invalid_sequence_id if there's no sequence with that prefix. */
+		SequenceId lookupSequenceId(std::string_view id_prefix) const;
+		/** The returned frames are only valid until the database is changed,
+		 * e.g. by mergeFrom() or a hot reload. */
+		Span<const IntRect> lookupSequence(SequenceId id) const;
+		Span<const IntRect> lookupSequence(std::string_view id_prefix) const;
 
-		IntRect lookup(const std::string& id) const { return sprite_db.at(id); }
-		std::vector<IntRect> lookupSequence(const std::string& id_prefix) const;
 		void loadFromCsv(const std::string& filename);
+		/** Replaces contents with the ones from o, keeping existing ids. Sprites
+		 * that don't exist in o are kept. */
+		void mergeFrom(const SpriteDb& o);
+
+	private:
+		SpriteId intern(std::string_view id);
+		void buildSequences();
 	};
 
 }
@@ -1,4 +1,5 @@
 #include "./SpriteMatrix.hpp"
+#include "simd.hpp"
 
 namespace yks {
 
@@ -29,10 +30,12 @@ namespace yks {
 
 		m(0, 0) = a*A + b*D;
 		m(0, 1) = a*B + b*E;
-		m(0, 2) = a*C + b*F + c;
+		// Sums of three are pinned so that -ffast-math adds them in the same
+		// order as the batch versions in SpriteBatch.hpp
+		m(0, 2) = noReassociate(a*C + b*F) + c;
 		m(1, 0) = d*A + e*D;
 		m(1, 1) = d*B + e*E;
-		m(1, 2) = d*C + e*F + f;
+		m(1, 2) = noReassociate(d*C + e*F) + f;
 
 		return *this;
 	}
@@ -105,9 +108,29 @@ namespace yks {
 		// d e f * y = d*x+e*y+f
 		// 0 0 1   1       1
 
+		// Pinned like in multiply()
 		return mvec2(
-			m(0, 0)*p[0] + m(0, 1)*p[1] + m(0, 2),
-			m(1, 0)*p[0] + m(1, 1)*p[1] + m(1, 2));
+			noReassociate(m(0, 0)*p[0] + m(0, 1)*p[1]) + m(0, 2),
+			noReassociate(m(1, 0)*p[0] + m(1, 1)*p[1]) + m(1, 2));
+	}
+
+	SpriteMatrix SpriteMatrix::inverse() const {
+		// The 2x2 part is inverted as usual, then the translation is undone
+		// by the inverted 2x2 part.
+
+		auto a = m(0, 0), b = m(0, 1), c = m(0, 2);
+		auto d = m(1, 0), e = m(1, 1), f = m(1, 2);
+		const float inv_det = 1.0f / (a*e - b*d);
+
+		SpriteMatrix r;
+		r.m(0, 0) = e * inv_det;
+		r.m(0, 1) = -b * inv_det;
+		r.m(1, 0) = -d * inv_det;
+		r.m(1, 1) = a * inv_det;
+		r.m(0, 2) = -(r.m(0, 0)*c + r.m(0, 1)*f);
+		r.m(1, 2) = -(r.m(1, 0)*c + r.m(1, 1)*f);
+
+		return r;
 	}
 
 }
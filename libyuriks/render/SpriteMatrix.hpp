@@ -21,6 +21,8 @@ namespace yks {
 		SpriteMatrix& translate(vec2 v);
 
 		vec2 transform(vec2 p) const;
+		/** Matrix undoing this one. The matrix must not be singular. */
+		SpriteMatrix inverse() const;
 	};
 
 }
@@ -0,0 +1,166 @@
+#include "TextureRegistry.hpp"
+#include <cassert>
+
+namespace yks {
+
+	TextureRegistry::TextureRegistry(size_t budget_bytes) {
+		stats.budget_bytes = budget_bytes;
+	}
+
+	Handle TextureRegistry::acquire(const std::string& filename, bool premultiply) {
+		auto i = handles_by_filename.find(filename);
+		if (i != handles_by_filename.end()) {
+			Entry* entry = entries[i->second];
+			assert(entry && entry->premultiply == premultiply);
+			entry->ref_count += 1;
+			return i->second;
+		}
+
+		Entry entry;
+		entry.filename = filename;
+		entry.premultiply = premultiply;
+		entry.ref_count = 1;
+		entry.resident = false;
+		entry.size_bytes = 0;
+		entry.last_used_frame = 0;
+		entry.last_used_tick = 0;
+
+		const Handle h = entries.emplace(std::move(entry));
+		handles_by_filename.emplace(filename, h);
+		stats.num_textures += 1;
+		return h;
+	}
+
+	void TextureRegistry::addRef(Handle h) {
+		if (Entry* entry = entries[h]) {
+			entry->ref_count += 1;
+		}
+	}
+
+	void TextureRegistry::release(Handle h) {
+		Entry* entry = entries[h];
+		if (entry == nullptr)
+			return;
+
+		assert(entry->ref_count > 0);
+		if (--entry->ref_count == 0) {
+			unload(*entry);
+			handles_by_filename.erase(entry->filename);
+			entries.remove(h);
+			stats.num_textures -= 1;
+		}
+	}
+
+	const TextureInfo* TextureRegistry::use(Handle h) {
+		Entry* entry = entries[h];
+		if (entry == nullptr)
+			return nullptr;
+
+		entry->last_used_frame = current_frame;
+		entry->last_used_tick = ++current_tick;
+
+		if (!entry->resident && !load(*entry))
+			return nullptr;
+
+		return &entry->texture;
+	}
+
+	void TextureRegistry::reload(const std::string& filename, const Image& image) {
+		auto i = handles_by_filename.find(filename);
+		if (i == handles_by_filename.end() || image.data == nullptr)
+			return;
+
+		Entry* entry = entries[i->second];
+		assert(entry != nullptr);
+		if (!entry->resident)
+			return; // Will pick up the new version when loaded again.
+
+		updateTexture(entry->texture, image.width, image.height, image.data.get());
+
+		stats.resident_bytes -= entry->size_bytes;
+		entry->size_bytes = size_t(image.width) * image.height * 4;
+		stats.resident_bytes += entry->size_bytes;
+		if (stats.resident_bytes > stats.peak_resident_bytes) {
+			stats.peak_resident_bytes = stats.resident_bytes;
+		}
+
+		// A bigger image can take us over budget. Count the reload as a use,
+		// so that trimming evicts other textures instead of this one.
+		entry->last_used_frame = current_frame;
+		entry->last_used_tick = ++current_tick;
+		trim();
+	}
+
+	void TextureRegistry::nextFrame() {
+		current_frame += 1;
+	}
+
+	void TextureRegistry::setBudget(size_t budget_bytes) {
+		stats.budget_bytes = budget_bytes;
+		trim();
+	}
+
+	void TextureRegistry::trim() {
+		makeRoomFor(0);
+	}
+
+	bool TextureRegistry::load(Entry& entry) {
+		assert(!entry.resident);
+
+		// If it was loaded before we already know how big it is, so make
+		// space before loading instead of going over budget.
+		if (entry.size_bytes != 0) {
+			makeRoomFor(entry.size_bytes);
+		}
+
+		entry.texture = loadTexture(entry.filename, entry.premultiply);
+		if (entry.texture.handle.name == 0)
+			return false;
+
+		entry.resident = true;
+		entry.size_bytes = size_t(entry.texture.width) * entry.texture.height * 4;
+
+		stats.resident_bytes += entry.size_bytes;
+		stats.num_resident += 1;
+		stats.num_loads += 1;
+		if (stats.resident_bytes > stats.peak_resident_bytes) {
+			stats.peak_resident_bytes = stats.resident_bytes;
+		}
+
+		trim();
+		return true;
+	}
+
+	void TextureRegistry::unload(Entry& entry) {
+		if (!entry.resident)
+			return;
+
+		entry.texture = TextureInfo();
+		entry.resident = false;
+
+		stats.resident_bytes -= entry.size_bytes;
+		stats.num_resident -= 1;
+	}
+
+	void TextureRegistry::makeRoomFor(size_t size_bytes) {
+		while (stats.resident_bytes + size_bytes > stats.budget_bytes) {
+			// Linear search is fine, since there are never many textures.
+			Entry* lru = nullptr;
+			for (Entry& entry : entries.pool) {
+				if (entry.resident && entry.last_used_frame != current_frame &&
+					(lru == nullptr || entry.last_used_tick < lru->last_used_tick))
+				{
+					lru = &entry;
+				}
+			}
+
+			// Everything left is in use this frame
+			if (lru == nullptr)
+				return;
+
+			unload(*lru);
+			stats.num_evictions += 1;
+		}
+	}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "texture.hpp"
+#include "memory/ObjectPool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace yks {
+
+	struct TextureMemoryStats {
+		size_t budget_bytes = SIZE_MAX;
+		size_t resident_bytes = 0;
+		size_t peak_resident_bytes = 0;
+
+		size_t num_textures = 0; // Registered, resident or not
+		size_t num_resident = 0;
+
+		size_t num_loads = 0; // Includes reloads of evicted textures
+		size_t num_evictions = 0;
+	};
+
+	/** Owns textures loaded from files, deduplicating them by path and keeping
+	 * the memory used by resident textures under a budget.
+	 *
+	 * When a load would exceed the budget, the least recently used textures
+	 * are evicted. An evicted texture keeps its handle and is transparently
+	 * reloaded the next time it's used. Textures used during the current frame
+	 * are never evicted, so the budget may be temporarily exceeded if a single
+	 * frame needs more than it allows. */
+	struct TextureRegistry {
+		explicit TextureRegistry(size_t budget_bytes = SIZE_MAX);
+
+		/** Returns a handle to the texture loaded from filename, adding a
+		 * reference to it. The file is only loaded on first use. */
+		Handle acquire(const std::string& filename, bool premultiply = true);
+		/** Adds a reference to an already acquired texture. */
+		void addRef(Handle h);
+		/** Removes a reference, unloading the texture if it was the last one. */
+		void release(Handle h);
+
+		/** Gets texture for rendering, (re)loading it if necessary. Returns
+		 * nullptr if the handle is invalid or the file failed to load. */
+		const TextureInfo* use(Handle h);
+
+		/** Replaces the contents of a texture with an already decoded image,
+		 * counting as a use of it, and evicts other textures if the new size
+		 * goes over budget. Does nothing if filename isn't registered or
+		 * isn't resident. */
+		void reload(const std::string& filename, const Image& image);
+
+		/** Marks the start of a new frame, allowing textures used on the
+		 * previous one to be evicted. */
+		void nextFrame();
+
+		void setBudget(size_t budget_bytes);
+		/** Evicts textures not used this frame until under budget. */
+		void trim();
+
+		const TextureMemoryStats& getStats() const { return stats; }
+		PoolStats getPoolStats() const { return entries.getStats(); }
+
+	private:
+		struct Entry {
+			std::string filename;
+			bool premultiply;
+			unsigned int ref_count;
+
+			TextureInfo texture;
+			bool resident;
+			size_t size_bytes;
+
+			uint64_t last_used_frame;
+			uint64_t last_used_tick; // For LRU ordering within a frame
+		};
+
+		ObjectPool<Entry> entries;
+		std::unordered_map<std::string, Handle> handles_by_filename;
+
+		uint64_t current_frame = 0;
+		uint64_t current_tick = 0;
+		TextureMemoryStats stats;
+
+		bool load(Entry& entry);
+		void unload(Entry& entry);
+		void makeRoomFor(size_t size_bytes);
+	};
+
+}
@@ -0,0 +1,39 @@
+#include "hot_reload.hpp"
+#include <memory>
+#include <utility>
+
+namespace yks {
+
+	void watchTexture(AssetWatcher& watcher, TextureRegistry& textures, const std::string& filename, bool premultiply) {
+		watcher.watch(filename, [&textures, premultiply](const std::string& changed_filename) -> AssetWatcher::ApplyFn {
+			// std::function needs to be copyable, so the image can't be moved into it directly.
+			auto image = std::make_shared<Image>(decodeImage(changed_filename, premultiply));
+			if (image->data == nullptr)
+				return nullptr;
+
+			return [&textures, changed_filename, image] {
+				textures.reload(changed_filename, *image);
+			};
+		});
+	}
+
+	void watchSpriteDb(AssetWatcher& watcher, SpriteDb& db, const std::string& filename) {
+		// The merged database is built on the watcher thread, which is the
+		// only one touching this copy. Reloads merge into the previous result
+		// rather than into db, so a reload still waiting to be applied doesn't
+		// lose the ids the one before it added.
+		auto merged = std::make_shared<SpriteDb>(db);
+
+		watcher.watch(filename, [&db, merged](const std::string& changed_filename) -> AssetWatcher::ApplyFn {
+			SpriteDb loaded;
+			loaded.loadFromCsv(changed_filename);
+			merged->mergeFrom(loaded);
+
+			auto new_db = std::make_shared<SpriteDb>(*merged);
+			return [&db, new_db] {
+				std::swap(db, *new_db);
+			};
+		});
+	}
+
+}
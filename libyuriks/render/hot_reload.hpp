@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include "AssetWatcher.hpp"
+#include "TextureRegistry.hpp"
+#include "SpriteDb.hpp"
+
+namespace yks {
+
+	/** Reloads texture filename in the registry whenever it changes on disk.
+	 * Decoding happens on the watcher thread, only the upload is done when
+	 * changes are applied. */
+	void watchTexture(AssetWatcher& watcher, TextureRegistry& textures, const std::string& filename, bool premultiply = true);
+
+	/** Updates the contents of db whenever filename changes on disk, keeping
+	 * its sprite ids valid. db should already be loaded. The new contents are
+	 * merged on the watcher thread and swapped in when changes are applied,
+	 * which invalidates spans returned by lookupSequence. */
+	void watchSpriteDb(AssetWatcher& watcher, SpriteDb& db, const std::string& filename);
+
+}
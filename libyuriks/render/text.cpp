@@ -1,32 +1,180 @@
 #include "text.hpp"
 #include "SpriteBuffer.hpp"
+#include <cassert>
+#include <functional>
+#include <string_view>
 
 namespace yks {
 
-	int measureStringWidth(const std::string& text, const FontInfo& font) {
-		return text.length() * font.char_w;
+	void FontInfo::setAdvances(const int* glyph_advances, size_t count) {
+		assert(count <= size_t(glyphCount()));
+		for (size_t i = 0; i < count; ++i) {
+			advances[uint8_t(first_char + i)] = static_cast<int16_t>(glyph_advances[i]);
+		}
 	}
 
-	void drawString(int x, int y, const std::string& text, SpriteBuffer& buffer, const FontInfo& font, const Color& color) {
-		Sprite spr;
-		spr.mat.transform(mvec2(x, y).typecast<float>());
-		spr.img = IntRect{ font.img_x, font.img_y, font.char_w, font.char_h };
-		spr.color = color;
+	void FontInfo::setKerning(char first, char second, int adjustment) {
+		const unsigned int a = uint8_t(first) - uint8_t(first_char);
+		const unsigned int b = uint8_t(second) - uint8_t(first_char);
+		const unsigned int n = glyphCount();
+		assert(a < n && b < n);
+
+		if (kerning.empty()) {
+			kerning.resize(n * n, 0);
+		}
+		kerning[a * n + b] = static_cast<int8_t>(adjustment);
+	}
+
+	int measureStringWidth(std::string_view text, const FontInfo& font) {
+		const uint8_t* chars = reinterpret_cast<const uint8_t*>(text.data());
+		const size_t len = text.size();
+
+		// Separate accumulators let the table lookups overlap.
+		int w0 = 0, w1 = 0, w2 = 0, w3 = 0;
+		size_t i = 0;
+		for (; i + 4 <= len; i += 4) {
+			w0 += font.advances[chars[i + 0]];
+			w1 += font.advances[chars[i + 1]];
+			w2 += font.advances[chars[i + 2]];
+			w3 += font.advances[chars[i + 3]];
+		}
+		for (; i < len; ++i) {
+			w0 += font.advances[chars[i]];
+		}
+
+		int width = w0 + w1 + w2 + w3;
+		if (!font.kerning.empty()) {
+			for (i = 1; i < len; ++i) {
+				width += font.getKerning(text[i - 1], text[i]);
+			}
+		}
+		return width;
+	}
+
+	bool nextTextLine(std::string_view text, size_t& pos, const FontInfo& font, int max_width, TextLine& line) {
+		if (pos >= text.size())
+			return false;
+
+		line.begin = pos;
+		int width = 0;
+
+		// Last space seen on this line, where it can be broken
+		size_t break_pos = std::string_view::npos;
+		int break_width = 0;
+
+		for (size_t i = pos; i < text.size(); ++i) {
+			const char c = text[i];
+			if (c == '\n') {
+				line.end = i;
+				line.width = width;
+				pos = i + 1;
+				return true;
+			}
+
+			int advance = font.getAdvance(c);
+			if (i > line.begin) {
+				advance += font.getKerning(text[i - 1], c);
+			}
+
+			if (c == ' ') {
+				break_pos = i;
+				break_width = width;
+			} else if (width + advance > max_width && i > line.begin) {
+				if (break_pos != std::string_view::npos) {
+					line.end = break_pos;
+					line.width = break_width;
+					pos = break_pos + 1;
+				} else {
+					line.end = i;
+					line.width = width;
+					pos = i;
+				}
+				return true;
+			}
+
+			width += advance;
+		}
+
+		line.end = text.size();
+		line.width = width;
+		pos = text.size();
+		return true;
+	}
+
+	size_t breakTextLines(std::string_view text, const FontInfo& font, int max_width, TextLine* lines, size_t max_lines) {
+		size_t count = 0;
+		size_t pos = 0;
+		TextLine line;
+		while (nextTextLine(text, pos, font, max_width, line)) {
+			if (count < max_lines) {
+				lines[count] = line;
+			}
+			++count;
+		}
+		return count;
+	}
+
+	void layoutString(vec2 origin, std::string_view text, const FontInfo& font, const Color& color, vec2i texture_size, std::vector<VertexData>& vertices) {
+		assert(texture_size[0] >= 0 && texture_size[1] >= 0);
+
+		const float inv_tex_w = 1.0f / static_cast<float>(texture_size[0]);
+		const float inv_tex_h = 1.0f / static_cast<float>(texture_size[1]);
+		const float char_w = static_cast<float>(font.char_w);
+		const float char_h = static_cast<float>(font.char_h);
+		const float glyph_s = font.char_w * inv_tex_w;
+		const float glyph_t = font.char_h * inv_tex_h;
+
+		VertexData v;
+		v.color[0] = color.r;
+		v.color[1] = color.g;
+		v.color[2] = color.b;
+		v.color[3] = color.a;
 
-		for (char c : text) {
+		vertices.reserve(vertices.size() + text.size() * 4);
+
+		int pen_x = 0;
+		const float y0 = origin[1];
+		const float y1 = origin[1] + char_h;
+
+		for (size_t i = 0; i < text.size(); ++i) {
+			const char c = text[i];
 			const int grid_pos = c - font.first_char;
 			const int grid_line = grid_pos / font.grid_w;
 			const int grid_col = grid_pos % font.grid_w;
 			assert(grid_line < font.grid_h);
 
-			spr.img.x = font.img_x + grid_col * font.char_w;
-			spr.img.y = font.img_y + grid_line * font.char_h;
-			buffer.append(spr);
-			spr.mat.transform(mvec2(font.char_w, 0).typecast<float>());
+			if (i > 0) {
+				pen_x += font.getKerning(text[i - 1], c);
+			}
+
+			const float x = origin[0] + pen_x;
+			const float s0 = (font.img_x + grid_col * font.char_w) * inv_tex_w;
+			const float t0 = (font.img_y + grid_line * font.char_h) * inv_tex_h;
+
+			// Same vertex order as SpriteBuffer::append
+			v.pos_x = x;          v.pos_y = y0; v.tex_s = s0;           v.tex_t = t0;           vertices.push_back(v);
+			v.pos_x = x + char_w; v.pos_y = y0; v.tex_s = s0 + glyph_s; v.tex_t = t0;           vertices.push_back(v);
+			v.pos_x = x + char_w; v.pos_y = y1; v.tex_s = s0 + glyph_s; v.tex_t = t0 + glyph_t; vertices.push_back(v);
+			v.pos_x = x;          v.pos_y = y1; v.tex_s = s0;           v.tex_t = t0 + glyph_t; vertices.push_back(v);
+
+			pen_x += font.getAdvance(c);
 		}
 	}
 
-	void drawString(int x, int y, const std::string& text, SpriteBuffer& buffer, const FontInfo& font, TextAlignment alignment, const Color& color) {
+	void layoutWrappedText(vec2 origin, std::string_view text, const FontInfo& font, int max_width, int line_height, const Color& color, vec2i texture_size, std::vector<VertexData>& vertices) {
+		size_t pos = 0;
+		TextLine line;
+		for (float y = origin[1]; nextTextLine(text, pos, font, max_width, line); y += line_height) {
+			layoutString(mvec2(origin[0], y), text.substr(line.begin, line.end - line.begin), font, color, texture_size, vertices);
+		}
+	}
+
+	void drawString(int x, int y, const std::string& text, SpriteBuffer& buffer, const FontInfo& font, const Color& color) {
+		layoutString(mvec2(x, y).typecast<float>(), text, font, color, buffer.texture_size, buffer.vertices);
+		buffer.sprite_count += static_cast<unsigned int>(text.size());
+	}
+
+	static int alignStringX(int x, const std::string& text, const FontInfo& font, TextAlignment alignment) {
 		switch (alignment) {
 		case TextAlignment::left:
 			break;
@@ -38,8 +186,56 @@ namespace yks {
 			x = (2*x - measureStringWidth(text, font)) / 2;
 			break;
 		}
+		return x;
+	}
 
-		drawString(x, y, text, buffer, font, color);
+	void drawString(int x, int y, const std::string& text, SpriteBuffer& buffer, const FontInfo& font, TextAlignment alignment, const Color& color) {
+		drawString(alignStringX(x, text, font, alignment), y, text, buffer, font, color);
+	}
+
+	Span<const VertexData> TextCache::getRun(const std::string& text, const FontInfo& font, const Color& color, vec2i texture_size) {
+		uint64_t key = std::hash<std::string_view>()(text);
+		auto combine = [&key](uint64_t v) {
+			key ^= v + 0x9E3779B97F4A7C15ull + (key << 6) + (key >> 2);
+		};
+		combine(reinterpret_cast<uintptr_t>(&font));
+		combine(uint64_t(color.r) | uint64_t(color.g) << 8 | uint64_t(color.b) << 16 | uint64_t(color.a) << 24);
+		combine(uint64_t(uint32_t(texture_size[0])) | uint64_t(uint32_t(texture_size[1])) << 32);
+
+		Run& run = runs[key];
+		run.last_used_frame = current_frame;
+
+		const bool hit = run.font == &font && run.text == text && run.texture_size == texture_size &&
+			run.color.r == color.r && run.color.g == color.g && run.color.b == color.b && run.color.a == color.a;
+		if (!hit) {
+			run.text = text;
+			run.font = &font;
+			run.color = color;
+			run.texture_size = texture_size;
+			run.vertices.clear();
+			layoutString(mvec2(0.0f, 0.0f), text, font, color, texture_size, run.vertices);
+		}
+
+		return run.vertices;
+	}
+
+	void TextCache::drawString(int x, int y, const std::string& text, SpriteBuffer& buffer, const FontInfo& font, const Color& color) {
+		buffer.appendVertices(getRun(text, font, color, buffer.texture_size), mvec2(x, y).typecast<float>());
+	}
+
+	void TextCache::drawString(int x, int y, const std::string& text, SpriteBuffer& buffer, const FontInfo& font, TextAlignment alignment, const Color& color) {
+		drawString(alignStringX(x, text, font, alignment), y, text, buffer, font, color);
+	}
+
+	void TextCache::nextFrame() {
+		for (auto i = runs.begin(); i != runs.end(); ) {
+			if (i->second.last_used_frame != current_frame) {
+				i = runs.erase(i);
+			} else {
+				++i;
+			}
+		}
+		current_frame += 1;
 	}
 
 }
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include "SpriteBuffer.hpp"
+#include "Span.hpp"
 
 namespace yks {
 
@@ -12,18 +17,102 @@ namespace yks {
 		int img_x, img_y;
 		int grid_w, grid_h; // In characters
 
+		// Horizontal advance of each character, indexed by its unsigned
+		// value. Filled with char_w unless setAdvances() is used.
+		int16_t advances[256];
+		// Kerning adjustment for each pair of glyphs in the grid, indexed by
+		// [first * glyph count + second]. Empty if the font has no kerning.
+		std::vector<int8_t> kerning;
+
 		FontInfo(char first_char, int char_w, int char_h, int img_x, int img_y, int grid_w, int grid_h)
 			: first_char(first_char), char_w(char_w), char_h(char_h),
 			img_x(img_x), img_y(img_y), grid_w(grid_w), grid_h(grid_h)
-		{ }
+		{
+			for (int16_t& a : advances) {
+				a = static_cast<int16_t>(char_w);
+			}
+		}
+
+		int glyphCount() const { return grid_w * grid_h; }
+
+		/** Makes the font proportional. glyph_advances has one entry per
+		 * glyph in the grid, starting at first_char. Glyphs are still drawn
+		 * using the full char_w wide cell. */
+		void setAdvances(const int* glyph_advances, size_t count);
+		void setKerning(char first, char second, int adjustment);
+
+		int getAdvance(char c) const { return advances[uint8_t(c)]; }
+		int getKerning(char first, char second) const {
+			if (kerning.empty())
+				return 0;
+			const unsigned int a = uint8_t(first) - uint8_t(first_char);
+			const unsigned int b = uint8_t(second) - uint8_t(first_char);
+			const unsigned int n = glyphCount();
+			return a < n && b < n ? kerning[a * n + b] : 0;
+		}
+	};
+
+	/** A line of text produced by line breaking, as a range of indices into
+	 * the string. Doesn't include the space or newline it was broken at. */
+	struct TextLine {
+		size_t begin, end;
+		int width;
 	};
 
 	enum class TextAlignment {
 		left, right, center
 	};
 
-	int measureStringWidth(const std::string& text, const FontInfo& font);
+	int measureStringWidth(std::string_view text, const FontInfo& font);
+
+	/** Finds the next line of text starting at pos, breaking at newlines and
+	 * at spaces to keep lines under max_width (or inside words if there's
+	 * no other option). Advances pos to the start of the following line.
+	 * Returns false when there is no more text. Doesn't allocate. */
+	bool nextTextLine(std::string_view text, size_t& pos, const FontInfo& font, int max_width, TextLine& line);
+	/** Breaks all of text into lines, writing up to max_lines of them.
+	 * Returns the number of lines needed for the whole text. */
+	size_t breakTextLines(std::string_view text, const FontInfo& font, int max_width, TextLine* lines, size_t max_lines);
+
+	/** Appends one quad per character of text to vertices, with the top-left corner of the first at origin. */
+	void layoutString(vec2 origin, std::string_view text, const FontInfo& font, const Color& color, vec2i texture_size, std::vector<VertexData>& vertices);
+	/** Lays out text wrapped to max_width, with lines line_height apart. */
+	void layoutWrappedText(vec2 origin, std::string_view text, const FontInfo& font, int max_width, int line_height, const Color& color, vec2i texture_size, std::vector<VertexData>& vertices);
 	void drawString(int x, int y, const std::string& text, SpriteBuffer& buffer, const FontInfo& font, const Color& color);
 	void drawString(int x, int y, const std::string& text, SpriteBuffer& buffer, const FontInfo& font, TextAlignment alignment, const Color& color);
 
+	/** Caches laid out strings, so drawing text that's the same as on the
+	 * previous frame is a single copy of its vertices into the buffer.
+	 * Strings are keyed by contents, font, color and texture size, but not
+	 * position, so moving text around doesn't need a new layout. */
+	struct TextCache {
+		/** Returns vertices for text laid out at the origin, laying it out if
+		 * it isn't in the cache yet. Valid until the next call. */
+		Span<const VertexData> getRun(const std::string& text, const FontInfo& font, const Color& color, vec2i texture_size);
+
+		void drawString(int x, int y, const std::string& text, SpriteBuffer& buffer, const FontInfo& font, const Color& color);
+		void drawString(int x, int y, const std::string& text, SpriteBuffer& buffer, const FontInfo& font, TextAlignment alignment, const Color& color);
+
+		/** Drops strings that weren't drawn since the previous call. Should be
+		 * called once per frame. */
+		void nextFrame();
+
+		size_t size() const { return runs.size(); }
+
+	private:
+		struct Run {
+			std::string text;
+			const FontInfo* font = nullptr;
+			Color color = color_white;
+			vec2i texture_size = { { -1, -1 } };
+
+			std::vector<VertexData> vertices;
+			uint64_t last_used_frame = 0;
+		};
+
+		// Keyed by hash of everything in the key. Collisions just replace the old run.
+		std::unordered_map<uint64_t, Run> runs;
+		uint64_t current_frame = 0;
+	};
+
 }
@@ -2,7 +2,6 @@
 
 #include "stb_image.h"
 #include "gl/gl_1_5.h"
-#include <memory>
 #include <cassert>
 
 #ifndef TEXTURE_MAX_ANISOTROPY_EXT
@@ -30,15 +29,28 @@ namespace yks {
 		return tex_info;
 	}
 
-	TextureInfo loadTexture(const std::string& filename, bool premultiply) {
-		int width, height, comp;
-		auto data = std::unique_ptr<unsigned char[], void(*)(void*)>(
-			stbi_load(filename.c_str(), &width, &height, &comp, 4), &stbi_image_free);
-		if (data == nullptr)
-			return TextureInfo();
+	void updateTexture(TextureInfo& tex_info, int width, int height, const uint8_t* data) {
+		glBindTexture(GL_TEXTURE_2D, tex_info.handle.name);
+		if (width == tex_info.width && height == tex_info.height) {
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		} else {
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+			tex_info.width = width;
+			tex_info.height = height;
+		}
+	}
+
+	Image decodeImage(const std::string& filename, bool premultiply) {
+		Image image;
+		int comp;
+		image.data = std::unique_ptr<uint8_t[], void(*)(void*)>(
+			stbi_load(filename.c_str(), &image.width, &image.height, &comp, 4), &stbi_image_free);
+		if (image.data == nullptr)
+			return Image();
 
 		if (premultiply) {
-			unsigned int size = width * height;
+			uint8_t* data = image.data.get();
+			unsigned int size = image.width * image.height;
 
 			for (unsigned int i = 0; i < size; ++i) {
 				unsigned char alpha = data[i*4 + 3];
@@ -48,7 +60,15 @@ namespace yks {
 			}
 		}
 
-		return loadTexture(width, height, data.get());
+		return image;
+	}
+
+	TextureInfo loadTexture(const std::string& filename, bool premultiply) {
+		Image image = decodeImage(filename, premultiply);
+		if (image.data == nullptr)
+			return TextureInfo();
+
+		return loadTexture(image.width, image.height, image.data.get());
 	}
 
 }
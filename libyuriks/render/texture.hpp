@@ -3,6 +3,8 @@
 #include "gl/Texture.hpp"
 #include <string>
 #include <cstdint>
+#include <cstdlib>
+#include <memory>
 
 namespace yks {
 
@@ -27,7 +29,18 @@ namespace yks {
 		NONCOPYABLE(TextureInfo);
 	};
 
+	/** RGBA8 pixels decoded from an image file, not yet uploaded to GL. */
+	struct Image {
+		int width = 0, height = 0;
+		std::unique_ptr<uint8_t[], void(*)(void*)> data{nullptr, &std::free};
+	};
+
+	/** Decodes an image file. Doesn't touch GL, so it's safe to call from any thread. */
+	Image decodeImage(const std::string& filename, bool premultiply = true);
+
 	TextureInfo loadTexture(int width, int height, const uint8_t* data);
 	TextureInfo loadTexture(const std::string& filename, bool premultiply = true);
+	/** Replaces contents of an existing texture, keeping its GL name. */
+	void updateTexture(TextureInfo& tex_info, int width, int height, const uint8_t* data);
 
 }
@@ -0,0 +1,38 @@
+#pragma once
+
+// SSE2 is always there on x64, and on x86 when building with /arch:SSE2 or
+// -msse2, which is the default for this project.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define YKS_HAS_SSE2 1
+#endif
+
+namespace yks {
+
+	/** Checks if the CPU and OS support AVX2, for code that picks an AVX2
+	 * version of a function at runtime. */
+	bool cpuSupportsAvx2();
+
+	/** Returns v, but keeps the compiler from merging the operations that
+	 * made it with later ones. With -ffast-math, GCC and Clang may reorder
+	 * sums, including ones written with SSE intrinsics, so code promising
+	 * results that match another version passes each partial sum through
+	 * this. Only float and __m128 are pinned. */
+	template <typename T>
+	inline T noReassociate(T v) {
+		return v;
+	}
+
+#if defined(YKS_HAS_SSE2) && defined(__GNUC__)
+	inline float noReassociate(float v) {
+		asm("" : "+x"(v));
+		return v;
+	}
+
+	inline __m128 noReassociate(__m128 v) {
+		asm("" : "+x"(v));
+		return v;
+	}
+#endif
+
+}
@@ -0,0 +1,64 @@
+#include "srgb.hpp"
+
+#include <cassert>
+#include <cstring>
+
+namespace yks {
+
+	namespace {
+		uint8_t byte_from_linear_reference(float x) {
+			return uint8_t(srgb_from_linear(x) * 255.0f + 0.5f);
+		}
+
+		/** Smallest x in [lo, 1] for which the reference gives at least b. */
+		float find_threshold(float lo, unsigned int b) {
+			// Bisect on the bit patterns, which are ordered like the values
+			// for positive floats.
+			uint32_t lo_bits, hi_bits;
+			const float one = 1.0f;
+			std::memcpy(&lo_bits, &lo, sizeof(float));
+			std::memcpy(&hi_bits, &one, sizeof(float));
+			while (lo_bits < hi_bits) {
+				const uint32_t mid_bits = lo_bits + (hi_bits - lo_bits) / 2;
+				float mid;
+				std::memcpy(&mid, &mid_bits, sizeof(float));
+				if (byte_from_linear_reference(mid) >= b) {
+					hi_bits = mid_bits;
+				} else {
+					lo_bits = mid_bits + 1;
+				}
+			}
+			float r;
+			std::memcpy(&r, &lo_bits, sizeof(float));
+			return r;
+		}
+
+		srgb_detail::ByteTable build_byte_table() {
+			using namespace srgb_detail;
+			ByteTable table;
+
+			float lo = 0.0f;
+			for (unsigned int b = 0; b < 255; ++b) {
+				lo = find_threshold(lo, b + 1);
+				table.threshold[b] = lo;
+			}
+			// Never reached, since byte_from_linear handles x >= 1 itself
+			table.threshold[255] = 2.0f;
+
+			unsigned int b = 0;
+			for (unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+				const float x = float(i) / float(NUM_BUCKETS);
+				while (x >= table.threshold[b]) ++b;
+				table.bucket_start[i] = uint8_t(b);
+				// byte_from_linear relies on no bucket spanning more than two results
+				assert(i == 0 || table.bucket_start[i] - table.bucket_start[i - 1] <= 1);
+			}
+			return table;
+		}
+	}
+
+	namespace srgb_detail {
+		const ByteTable byte_table = build_byte_table();
+	}
+
+}
@@ -18,8 +18,37 @@ namespace yks {
 			std::pow((x + 0.055f) / 1.055f, 2.4f);
 	}
 
+	namespace srgb_detail {
+		static const unsigned int NUM_BUCKETS = 4096;
+
+		struct ByteTable {
+			// Result for the start of each of NUM_BUCKETS equal parts of [0, 1)
+			uint8_t bucket_start[NUM_BUCKETS];
+			// threshold[b] is the smallest x giving b + 1
+			float threshold[256];
+		};
+
+		/** Built from srgb_from_linear during static initialization. */
+		extern const ByteTable byte_table;
+	}
+
+	/** Converts linear x to an 8-bit sRGB value, giving the same result as
+	 * rounding srgb_from_linear(x) * 255, but using a lookup table instead of
+	 * pow. x is clamped to [0, 1]. Mustn't be used during static
+	 * initialization, since the table might not be built yet. */
 	inline uint8_t byte_from_linear(float x) {
-		return uint8_t(srgb_from_linear(x) * 255.0f + 0.5f);
+		using namespace srgb_detail;
+		// Also maps NaN to 0
+		if (!(x > 0.0f))
+			return 0;
+		if (x >= 1.0f)
+			return 255;
+
+		// Buckets are small enough that the result is either the one at the
+		// start of the bucket or the next one
+		unsigned int b = byte_table.bucket_start[static_cast<unsigned int>(x * float(NUM_BUCKETS))];
+		b += x >= byte_table.threshold[b] ? 1 : 0;
+		return uint8_t(b);
 	}
 
 	const mat3 XYZ_from_sRGB = {{
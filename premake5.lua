@@ -2,6 +2,7 @@ solution "SuperMatch5DX"
 	configurations { "Debug", "Release" }
 
 	flags { "FatalWarnings", "NoRTTI", "Unicode" }
+	cppdialect "C++17"
 	warnings "Extra"
 	floatingpoint "Fast"
 	vectorextensions "SSE2"
@@ -9,7 +10,7 @@ solution "SuperMatch5DX"
 	targetdir "bin"
 
 	configuration "Debug"
-		defines { "DEBUG" }
+		defines { "DEBUG", "YKS_POOL_STATS=1" }
 		flags { "Symbols" }
 		optimize "Off"
 
@@ -26,16 +27,64 @@ solution "SuperMatch5DX"
 		files { "libyuriks/**.cpp", "libyuriks/**.hpp", "libyuriks/**.c", "libyuriks/**.h" }
 		includedirs { "libyuriks" }
 
+		-- Only the AVX2 kernels, which are called after checking the CPU
+		filter "files:libyuriks/render/SpriteBatchAvx2.cpp"
+			vectorextensions "AVX2"
+		filter {}
+
 	project "SuperMatch5DX"
 		kind "ConsoleApp"
 		language "C++"
 		files { "src/**.cpp", "src/**.hpp", "src/**.c", "src/**.h" }
-		includedirs { "src", "libyuriks" }
+		includedirs { "src", "libyuriks", "generated" }
 
 		links { "SDL2", "SDL2main", "libyuriks" }
 
+		-- Sprite tables are generated from the sheet CSVs on every build
+		dependson { "spritegen" }
+		prebuildcommands {
+			'"%{cfg.targetdir}/spritegen" data/cards.csv data/cards.png generated/card_sprites.hpp card_sprites',
+		}
+
 		configuration "Windows"
 			links { "OpenGL32" }
 
+		configuration "linux"
+			links { "pthread" }
+
 		configuration { "Windows", "Debug" }
 			linkoptions { "/NODEFAULTLIB:msvcrt" }
+
+	project "spritegen"
+		kind "ConsoleApp"
+		language "C++"
+		files { "tools/spritegen/**.cpp", "tools/spritegen/**.hpp" }
+		includedirs { "libyuriks" }
+
+		links { "libyuriks" }
+
+	project "spritecook"
+		kind "ConsoleApp"
+		language "C++"
+		files { "tools/spritecook/**.cpp", "tools/spritecook/**.hpp" }
+		includedirs { "libyuriks" }
+
+		links { "libyuriks" }
+
+		configuration "linux"
+			links { "pthread" }
+
+	project "benchmarks"
+		kind "ConsoleApp"
+		language "C++"
+		files { "bench/**.cpp", "bench/**.hpp" }
+		includedirs { "bench", "libyuriks" }
+
+		links { "libyuriks" }
+
+		-- Nothing calls GL, but the render code in libyuriks references it
+		configuration "Windows"
+			links { "OpenGL32" }
+
+		configuration "linux"
+			links { "GL", "pthread" }
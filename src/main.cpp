@@ -10,13 +10,20 @@
 #include <numeric>
 #include "range_macro.hpp"
 #include <cassert>
-#include "render/texture.hpp"
+#include "render/TextureRegistry.hpp"
+#include "render/hot_reload.hpp"
+#include "AssetWatcher.hpp"
+#include "memory/FrameArena.hpp"
 #include "gl/gl_1_5.h"
 #include "math/MatrixTransform.hpp"
 #include "math/misc.hpp"
+#include "math/fastmath.hpp"
 #include "srgb.hpp"
+#include "card_sprites.hpp"
 
 static const unsigned int NUM_CARD_SPRITES = 13;
+static_assert(int(card_sprites::Id::card13) - int(card_sprites::Id::card1) + 1 == NUM_CARD_SPRITES,
+	"data/cards.csv should have NUM_CARD_SPRITES consecutive card sprites");
 static const int CARD_WIDTH = 64;
 static const int CARD_HEIGHT = 64;
 
@@ -80,12 +87,29 @@ struct YksDrawState {
 	yks::SpriteBufferIndices sprite_buffer_indices;
 	yks::SpriteBuffer card_buffer;
 
-	yks::TextureInfo card_texture;
+	yks::TextureRegistry textures;
+	yks::Handle card_texture;
+	// Follow the size of the card texture, which can change on reload
+	std::array<yks::UvRect, size_t(card_sprites::Id::COUNT)> card_uvs;
+
+	yks::AssetWatcher asset_watcher;
+
+	// For data which only has to live until the end of the next frame
+	yks::DoubleBufferedArena frame_arena;
 
 	YksDrawState()
-		: card_texture(yks::loadTexture("data/cards.png"))
+		: card_texture(textures.acquire("data/cards.png"))
 	{
-		card_buffer.texture_size = yks::mvec2(card_texture.width, card_texture.height);
+		yks::watchTexture(asset_watcher, textures, "data/cards.png");
+		updateTextureSize();
+	}
+
+	void updateTextureSize() {
+		const yks::TextureInfo* tex = textures.use(card_texture);
+		assert(tex != nullptr); // TODO: ERROR_CHECK
+		card_buffer.texture_size = yks::mvec2(tex->width, tex->height);
+		yks::makeUvRects(yks::Span<const yks::IntRect>(card_sprites::rects, card_uvs.size()),
+			card_buffer.texture_size, yks::Span<yks::UvRect>(card_uvs.data(), card_uvs.size()));
 	}
 };
 
@@ -156,37 +180,60 @@ void update_game(GameState& state, WindowEventInfo& event_info) {
 
 void draw_game(const GameState& game_state, YksDrawState& draw_state) {
 	// Draw cards
+	const size_t card_count = game_state.cards.size();
+	yks::ArenaAllocator<yks::Sprite> arena_alloc(draw_state.frame_arena.current());
+	std::vector<yks::Sprite, yks::ArenaAllocator<yks::Sprite>> card_sprs(arena_alloc);
+	std::vector<yks::UvRect, yks::ArenaAllocator<yks::UvRect>> card_uvs(arena_alloc);
+	card_sprs.reserve(card_count);
+	card_uvs.reserve(card_count);
+
+	// Flip animation scales of all cards, 4 at a time where possible
+	std::vector<float, yks::ArenaAllocator<float>> card_hscales(card_count, 0.0f, arena_alloc);
+	size_t card_i = 0;
+#ifdef YKS_HAS_SSE2
+	for (; card_i + 4 <= card_count; card_i += 4) {
+		const __m128 angle = _mm_mul_ps(_mm_loadu_ps(&game_state.card_anim_state[card_i]), _mm_set1_ps(yks::pi));
+		_mm_storeu_ps(&card_hscales[card_i], yks::fast_cos(angle));
+	}
+#endif
+	for (; card_i < card_count; ++card_i) {
+		card_hscales[card_i] = yks::fast_cos(game_state.card_anim_state[card_i] * yks::pi);
+	}
+
 	yks::Sprite card_spr;
 
 	for (int y = 0; y < game_state.playfield_height; ++y) {
 		for (int x = 0; x < game_state.playfield_width; ++x) {
 			const size_t card_index = y * game_state.playfield_width + x;
-			const float card_hscale = std::cos(game_state.card_anim_state[card_index] * yks::pi);
+			const float card_hscale = card_hscales[card_index];
 			const yks::vec2 half_card = yks::mvec2(0.5f * CARD_WIDTH, 0.5f * CARD_HEIGHT);
 
 			uint8_t col = yks::byte_from_linear(std::abs(card_hscale));
 			card_spr.color = yks::Color{ col, col, col, 255 };
+			card_sprites::Id sprite = card_sprites::Id::back;
 			if (card_hscale < 0.0f) {
-				const int tile_i = game_state.cards[card_index] + 1;
-				const int tile_x = tile_i % 4;
-				const int tile_y = tile_i / 4;
-				card_spr.img = yks::IntRect{ tile_x * CARD_WIDTH, tile_y * CARD_HEIGHT, CARD_WIDTH, CARD_HEIGHT };
-			} else {
-				card_spr.img = yks::IntRect{ 0, 0, CARD_WIDTH, CARD_HEIGHT };
+				sprite = card_sprites::Id(int(card_sprites::Id::card1) + game_state.cards[card_index]);
 			}
+			card_spr.img = card_sprites::rect(sprite);
 			card_spr.mat.identity()
 				.translate(-half_card)
 				.scale(yks::mvec2(std::abs(card_hscale), 1.0f))
 				.translate(half_card + yks::mvec2(x * (CARD_WIDTH + 8), y * (CARD_HEIGHT + 8)).typecast<float>());
-			draw_state.card_buffer.append(card_spr);
+			card_sprs.push_back(card_spr);
+			card_uvs.push_back(draw_state.card_uvs[size_t(sprite)]);
 		}
 	}
+	draw_state.card_buffer.append(card_sprs, card_uvs);
 
 	// Submit everything
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	glBindTexture(GL_TEXTURE_2D, draw_state.card_texture.handle.name);
-	draw_state.card_buffer.draw(draw_state.sprite_buffer_indices);
+	// Skip the cards if their texture failed to (re)load, rather than
+	// drawing them with whatever texture is bound
+	if (const yks::TextureInfo* card_tex = draw_state.textures.use(draw_state.card_texture)) {
+		glBindTexture(GL_TEXTURE_2D, card_tex->handle.name);
+		draw_state.card_buffer.draw(draw_state.sprite_buffer_indices);
+	}
 	draw_state.card_buffer.clear();
 
 	YKS_CHECK_GL_PARANOID;
@@ -228,6 +275,9 @@ void game_loop(Window& window) {
 	std::array<int32_t, 60> frametimes;
 	unsigned int frametimes_pos = 0;
 	frametimes.fill(static_cast<int32_t>(fixed_frame_time));
+#if YKS_POOL_STATS
+	unsigned int frames_since_pool_report = 0;
+#endif
 
 	setup_intial_opengl_state();
 
@@ -244,7 +294,12 @@ void game_loop(Window& window) {
 			game_state.running = false;
 		}
 
+		draw_state.frame_arena.nextFrame();
 		update_game(game_state, event_info);
+		draw_state.textures.nextFrame();
+		if (draw_state.asset_watcher.applyPendingChanges() != 0) {
+			draw_state.updateTextureSize();
+		}
 		draw_game(game_state, draw_state);
 
 		window.swapBuffers();
@@ -252,6 +307,14 @@ void game_loop(Window& window) {
 		const double frametime_avg = std::accumulate(frametimes.cbegin(), frametimes.cend(), 0.0) / frametimes.size();
 		std::cout << "FRAMETIME: " << frametime_avg << '\n';
 
+#if YKS_POOL_STATS
+		if (++frames_since_pool_report >= 600) {
+			yks::printPoolStatsHeader(std::cout);
+			yks::printPoolStats(std::cout, "textures", draw_state.textures.getPoolStats());
+			frames_since_pool_report = 0;
+		}
+#endif
+
 		const int32_t time_elapsed_in_frame = window.getTicks() - frame_start;
 
 		if (time_elapsed_in_frame < desired_frame_time) {
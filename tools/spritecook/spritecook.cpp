@@ -0,0 +1,21 @@
+#include "render/SpriteDb.hpp"
+#include "render/CompiledSpriteDb.hpp"
+#include <cstdio>
+
+// Converts a sprite CSV into the binary format loaded by CompiledSpriteDb.
+int main(int argc, char* argv[]) {
+	if (argc != 3) {
+		std::fprintf(stderr, "usage: %s <sprites.csv> <sprites.ysdb>\n", argv[0]);
+		return 2;
+	}
+
+	yks::SpriteDb db;
+	db.loadFromCsv(argv[1]);
+
+	if (!yks::writeCompiledSpriteDb(db, argv[2])) {
+		std::fprintf(stderr, "%s: failed to write %s\n", argv[0], argv[2]);
+		return 1;
+	}
+
+	return 0;
+}
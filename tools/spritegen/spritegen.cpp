@@ -0,0 +1,152 @@
+#include "csv.hpp"
+#include "MappedFile.hpp"
+#include "stb_image.h"
+#include <cstdio>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+// Generates a header with constexpr tables for the sprites in a CSV, so they
+// can be referenced by enum instead of looked up by name at runtime. Fails if
+// the CSV doesn't match the texture, so an out of date sheet breaks the build.
+
+struct SpriteRow {
+	std::string name;
+	int x, y, w, h;
+};
+
+static bool isIdentifier(const std::string& s) {
+	if (s.empty() || (s[0] >= '0' && s[0] <= '9'))
+		return false;
+	for (char c : s) {
+		const bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+		if (!valid)
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc != 5) {
+		std::fprintf(stderr, "usage: %s <sprites.csv> <texture.png> <output.hpp> <namespace>\n", argv[0]);
+		return 2;
+	}
+	const char* csv_filename = argv[1];
+	const char* texture_filename = argv[2];
+	const char* output_filename = argv[3];
+	const char* namespace_name = argv[4];
+
+	int tex_w, tex_h, tex_comp;
+	if (!stbi_info(texture_filename, &tex_w, &tex_h, &tex_comp)) {
+		std::fprintf(stderr, "%s: error: can't read texture\n", texture_filename);
+		return 1;
+	}
+
+	yks::MappedFile csv_file(csv_filename);
+	if (!csv_file.isValid()) {
+		std::fprintf(stderr, "%s: error: can't read file\n", csv_filename);
+		return 1;
+	}
+
+	std::vector<SpriteRow> sprites;
+	std::set<std::string> names;
+	bool ok = true;
+
+	yks::CsvReader csv(csv_file.view());
+	for (int line = 1; csv.nextRow(); ++line) {
+		SpriteRow s;
+		s.name = std::string(csv.nextField());
+
+		const bool parsed = yks::parseCsvInt(csv.nextField(), s.x) &&
+			yks::parseCsvInt(csv.nextField(), s.y) &&
+			yks::parseCsvInt(csv.nextField(), s.w) &&
+			yks::parseCsvInt(csv.nextField(), s.h);
+
+		if (!parsed) {
+			std::fprintf(stderr, "%s:%d: error: expected name,x,y,w,h\n", csv_filename, line);
+			ok = false;
+		} else if (!isIdentifier(s.name)) {
+			std::fprintf(stderr, "%s:%d: error: '%s' isn't a valid identifier\n", csv_filename, line, s.name.c_str());
+			ok = false;
+		} else if (!names.insert(s.name).second) {
+			std::fprintf(stderr, "%s:%d: error: duplicate sprite '%s'\n", csv_filename, line, s.name.c_str());
+			ok = false;
+		} else if (s.x < 0 || s.y < 0 || s.w <= 0 || s.h <= 0 || s.x + s.w > tex_w || s.y + s.h > tex_h) {
+			std::fprintf(stderr, "%s:%d: error: sprite '%s' is outside of %dx%d texture %s\n",
+				csv_filename, line, s.name.c_str(), tex_w, tex_h, texture_filename);
+			ok = false;
+		}
+
+		sprites.push_back(s);
+	}
+
+	if (!ok)
+		return 1;
+
+	std::string out;
+	char buf[256];
+
+	out += "// Generated by spritegen from ";
+	out += csv_filename;
+	out += ". Do not edit.\n";
+	out += "#pragma once\n\n#include <cstddef>\n#include <cstdint>\n#include \"render/Sprite.hpp\"\n\n";
+	out += "namespace ";
+	out += namespace_name;
+	out += " {\n\n";
+
+	// UVs aren't generated, since the texture can change size when it's
+	// hot reloaded. Use yks::makeUvRects() with the rects instead.
+	out += "\t// Size of the texture the rects were checked against\n";
+	std::snprintf(buf, sizeof(buf), "\tconstexpr int texture_width = %d;\n\tconstexpr int texture_height = %d;\n\n", tex_w, tex_h);
+	out += buf;
+
+	out += "\tenum class Id : uint16_t {\n";
+	for (const SpriteRow& s : sprites) {
+		out += "\t\t" + s.name + ",\n";
+	}
+	out += "\t\tCOUNT\n\t};\n\n";
+
+	out += "\tconstexpr yks::IntRect rects[] = {\n";
+	for (const SpriteRow& s : sprites) {
+		std::snprintf(buf, sizeof(buf), "\t\t{ %d, %d, %d, %d }, // %s\n", s.x, s.y, s.w, s.h, s.name.c_str());
+		out += buf;
+	}
+	out += "\t};\n\n";
+
+	out += "\tconstexpr const yks::IntRect& rect(Id id) { return rects[size_t(id)]; }\n\n";
+
+	out += "}\n";
+
+	// Only touch the output if it changed, to avoid needless rebuilds.
+	{
+		yks::MappedFile existing(output_filename);
+		if (existing.isValid() && existing.view() == out)
+			return 0;
+	}
+
+	const std::filesystem::path output_path(output_filename);
+	if (output_path.has_parent_path()) {
+		std::error_code ec;
+		std::filesystem::create_directories(output_path.parent_path(), ec);
+	}
+
+	std::FILE* f = std::fopen(output_filename, "wb");
+	if (f == nullptr) {
+		std::fprintf(stderr, "%s: error: can't write file\n", output_filename);
+		return 1;
+	}
+	// fclose flushes, so it can fail even if fwrite didn't. Either way, don't
+	// leave a truncated header for the build to pick up.
+	const bool written = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+	if (std::fclose(f) != 0 || !written) {
+		std::fprintf(stderr, "%s: error: can't write file\n", output_filename);
+		std::error_code ec;
+		if (std::filesystem::is_regular_file(output_path, ec)) {
+			std::remove(output_filename);
+		}
+		return 1;
+	}
+
+	return 0;
+}